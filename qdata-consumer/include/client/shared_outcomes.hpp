@@ -0,0 +1,322 @@
+// SVM Order Parameters for Hidden Spin Order
+// Copyright (C) 2018-2019  Jonas Greitemann, Ke Liu, and Lode Pollet
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+namespace client {
+
+// The POVM outcomes of a data file, decoded once per node into a POSIX
+// shared-memory segment which all processes working on that file map, be it
+// as ranks of the same batch group or of different runs. The segment is named
+// after the path, size, and modification time of the file.
+//
+// The holders of a segment are tracked by open file description locks, which
+// the kernel releases when a process dies: the creator holds a write lock
+// while decoding, every other holder a read lock. Whoever can take the write
+// lock when detaching is the last holder and removes the segment, provided
+// the name still refers to it. Hence, a segment left behind by killed
+// processes is taken over and removed by the next one to use it. If shared
+// memory (or such locks) are not available, the outcomes are decoded into
+// private memory instead.
+class shared_outcomes {
+public:
+    using value_type = float;
+
+    shared_outcomes(std::string const& file_name) {
+        std::ifstream is(file_name);
+        if (!is)
+            throw std::runtime_error("could not open file: " + file_name);
+        struct stat st;
+        if (stat(file_name.c_str(), &st) != 0)
+            throw std::runtime_error("could not stat file: " + file_name);
+        name = segment_name(file_name, st);
+
+#ifdef F_OFD_SETLK
+        for (int i = 0; i < max_polls; ++i) {
+            int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+            if (fd >= 0) {
+                if (create(fd, is))
+                    return;
+                break;
+            }
+            if (errno != EEXIST)
+                break;
+            fd = shm_open(name.c_str(), O_RDWR, 0);
+            if (fd < 0 && errno != ENOENT)
+                break;
+            // otherwise, the segment has been removed meanwhile or was stale
+            if (fd >= 0 && attach(fd))
+                return;
+        }
+#endif
+
+        // no shared memory; hold the outcomes privately
+        name.clear();
+        read_dimensions(is, n_line_, n_shots_);
+        private_data.resize(n_line_ * n_shots_);
+        decode(is, private_data.data(), private_data.size());
+        data_ = private_data.data();
+    }
+
+    shared_outcomes(shared_outcomes const&) = delete;
+    shared_outcomes& operator=(shared_outcomes const&) = delete;
+    shared_outcomes(shared_outcomes &&) = delete;
+    shared_outcomes& operator=(shared_outcomes &&) = delete;
+
+    ~shared_outcomes() {
+        detach();
+    }
+
+    // number of outcomes per shot, i.e. per line of the file
+    size_t n_line() const { return n_line_; }
+
+    size_t n_shots() const { return n_shots_; }
+
+    value_type const* data() const { return data_; }
+
+    bool is_shared() const { return segment != nullptr; }
+
+private:
+    enum : int { decoding = 0, ready = 1, failed = 2 };
+
+    static_assert(ATOMIC_INT_LOCK_FREE == 2,
+                  "atomics in shared memory must be lock-free");
+
+    // zero-initialized by ftruncate, i.e. in the decoding state
+    struct header {
+        std::atomic<int> state;
+        std::uint64_t n_line;
+        std::uint64_t n_shots;
+    };
+
+    static std::string segment_name(std::string const& file_name,
+                                    struct stat const& st)
+    {
+        std::stringstream ss;
+        ss << getuid() << ':' << file_name << ':' << st.st_size << ':'
+           << st.st_mtime;
+        std::stringstream name_ss;
+        name_ss << "/qdata-" << std::hex << std::hash<std::string>{}(ss.str());
+        return name_ss.str();
+    }
+
+    // The first line determines the number of outcomes per shot; the number
+    // of shots follows from the size of the file.
+    static void read_dimensions(std::ifstream & is,
+                                size_t & n_line,
+                                size_t & n_shots)
+    {
+        is.clear();
+        is.seekg(0);
+        std::string first_line;
+        std::getline(is, first_line);
+        std::stringstream ss{first_line};
+        n_line = std::distance(std::istream_iterator<double>{ss},
+                               std::istream_iterator<double>{});
+
+        is.seekg(0, std::ios::end);
+        size_t line_size = first_line.size() + 1;
+        n_shots = is.tellg() / line_size - 1;
+
+        if (is.tellg() % line_size != 0)
+    #pragma omp critical
+        {
+            std::cerr << "warning: file size not a multiple of first line\n"
+                      << "file size: " << is.tellg() << "\t1st line: "
+                      << line_size << '\n';
+        }
+    }
+
+    static void decode(std::ifstream & is, value_type * out, size_t n) {
+        is.clear();
+        is.seekg(0);
+        for (size_t i = 0; i < n; ++i) {
+            double outcome;
+            is >> outcome;
+            out[i] = outcome;
+        }
+    }
+
+    bool create(int fd, std::ifstream & is) {
+        fd_ = fd;
+        if (!lock(F_WRLCK, true)) {
+            shm_unlink(name.c_str());
+            detach();
+            return false;
+        }
+        size_t n_line, n_shots;
+        read_dimensions(is, n_line, n_shots);
+        size = sizeof(header) + sizeof(value_type) * n_line * n_shots;
+        if (ftruncate(fd_, size) != 0 || !map()) {
+            shm_unlink(name.c_str());
+            detach();
+            return false;
+        }
+        segment->n_line = n_line;
+        segment->n_shots = n_shots;
+        n_line_ = n_line;
+        n_shots_ = n_shots;
+        try {
+            decode(is, shared_data(), n_line * n_shots);
+        } catch (...) {
+            segment->state = failed;
+            detach();
+            throw;
+        }
+        segment->state.store(ready, std::memory_order_release);
+        // let the processes waiting for the outcomes in
+        lock(F_RDLCK, false);
+        return true;
+    }
+
+    bool attach(int fd) {
+        fd_ = fd;
+        // waits for the creator to finish decoding (or to die)
+        if (!lock(F_RDLCK, true)) {
+            close(fd_);
+            fd_ = -1;
+            return false;
+        }
+        // the name may have been reused since the segment was opened
+        if (!is_current()) {
+            close(fd_);
+            fd_ = -1;
+            return false;
+        }
+        // the creator sizes the segment right after locking it; an empty
+        // segment was left by a process which died before
+        struct stat st;
+        for (int i = 0; fstat(fd_, &st) == 0 && st.st_size == 0; ++i) {
+            if (i == max_polls) {
+                detach();
+                return false;
+            }
+            lock(F_UNLCK, false);
+            poll_wait();
+            lock(F_RDLCK, true);
+        }
+        size = st.st_size;
+        if (!map()
+            || segment->state.load(std::memory_order_acquire) != ready)
+        {
+            // decoding failed or its process died
+            detach();
+            return false;
+        }
+        n_line_ = segment->n_line;
+        n_shots_ = segment->n_shots;
+        data_ = shared_data();
+        return true;
+    }
+
+    bool map() {
+        void * addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                           fd_, 0);
+        if (addr == MAP_FAILED)
+            return false;
+        segment = static_cast<header *>(addr);
+        data_ = shared_data();
+        return true;
+    }
+
+    // Gives up the read lock first, such that of several processes detaching
+    // at the same time, the last one obtains the write lock.
+    void detach() {
+        if (fd_ < 0)
+            return;
+        if (segment)
+            munmap(segment, size);
+        segment = nullptr;
+        data_ = nullptr;
+        lock(F_UNLCK, false);
+        if (lock(F_WRLCK, false) && is_current())
+            shm_unlink(name.c_str());
+        close(fd_);
+        fd_ = -1;
+    }
+
+#ifdef F_OFD_SETLK
+    bool lock(short type, bool wait) {
+        struct flock fl = {};
+        fl.l_type = type;
+        fl.l_whence = SEEK_SET;
+        int cmd = wait ? F_OFD_SETLKW : F_OFD_SETLK;
+        while (fcntl(fd_, cmd, &fl) != 0)
+            if (errno != EINTR)
+                return false;
+        return true;
+    }
+#else
+    bool lock(short, bool) { return false; }
+#endif
+
+    // whether the name still refers to the segment held
+    bool is_current() const {
+        int fd = shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd < 0)
+            return false;
+        struct stat st_name, st_held;
+        bool same = fstat(fd, &st_name) == 0 && fstat(fd_, &st_held) == 0
+            && st_name.st_dev == st_held.st_dev
+            && st_name.st_ino == st_held.st_ino;
+        close(fd);
+        return same;
+    }
+
+    value_type * shared_data() const {
+        return reinterpret_cast<value_type *>(segment + 1);
+    }
+
+    static void poll_wait() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    static constexpr int max_polls = 1000;
+
+    std::string name;
+    int fd_ = -1;
+    header * segment = nullptr;
+    size_t size = 0;
+    size_t n_line_ = 0;
+    size_t n_shots_ = 0;
+    value_type const* data_ = nullptr;
+    std::vector<value_type> private_data;
+};
+
+}
@@ -23,6 +23,7 @@
 #include <random>
 #include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <tksvm/config/policy.hpp>
@@ -41,6 +42,7 @@
 
 #include <client/config_policy.hpp>
 #include <client/phase_point.hpp>
+#include <client/shared_outcomes.hpp>
 
 namespace client {
 
@@ -61,13 +63,23 @@ public:
 
 private:
     std::string data_path;
-    std::ifstream is;
+    // outcomes of the data file, shared among the processes of a node
+    std::unique_ptr<shared_outcomes> outcomes;
+    // number of shots mapped so far and in total by this rank
     size_t sweeps;
-    size_t total_sweeps;
+    size_t total_sweeps = 0;
+    // rank and size of the batch group, which partitions the shots of the
+    // data file, and the position of this rank's slice within it
+    std::pair<int, int> group_slice{0, 0};
+    size_t slice_begin = 0;
     std::mt19937 rng;
     phase_point ppoint;
+    // shots mapped by the latest update()
     std::vector<lattice_type> all_samples;
 
+    // number of shots mapped per update(), in between which the time limit
+    // is checked
+    static constexpr size_t shots_per_update = 1000;
 
 public:
     static void define_parameters(parameters_type & parameters) {
@@ -104,13 +116,28 @@ public:
     virtual void update() override {
         //std::copy_n(std::istream_iterator<site_type>{is}, lattice.size(), lattice.begin());
 
+        if (!outcomes) {
+            // resumed from a checkpoint
+            size_t checkpoint_sweeps = total_sweeps;
+            open_slice();
+            if (total_sweeps != checkpoint_sweeps)
+                throw std::runtime_error("data file " + data_file_name(
+                    data_path, ppoint) + " has changed since the checkpoint");
+        }
+
+        // map the next portion of the shots of this rank's slice
+        size_t n = std::min(size_t{shots_per_update}, total_sweeps - sweeps);
+        if (all_samples.size() < n)
+            all_samples.resize(n, lattice_type(all_samples.front()));
+        else
+            all_samples.resize(n);
+        size_t position = slice_begin + sweeps * outcomes->n_line();
         for (auto& lattice : all_samples) {
             for (auto it = lattice.begin(); it != lattice.end(); ++it) {
 
                 //client-specific: choose POVM
                 /* TETRA POVM Spin 1/2 Decker orientation, see ref [Decker03]
-                double povm_outcome;
-                is >> povm_outcome;
+                double povm_outcome = outcomes->data()[position++];
                 if (povm_outcome == 0)      //Pt1
                     *it = site_type{(Eigen::Vector3d() <<  sqrt(2./3.), 0,  1./sqrt(3.)).finished()};
                 else if (povm_outcome == 1) //Pt2
@@ -125,8 +152,7 @@ public:
 
                 //client-specific: choose POVM
                 ///* Pauli-6 POVM Mapping (Spin 1/2)
-                double povm_outcome;
-                is >> povm_outcome;
+                double povm_outcome = outcomes->data()[position++];
                 if (povm_outcome == 0)      //xup
                     *it = site_type{(Eigen::Vector3d() <<  +1,  0,  0).finished()};
                 else if (povm_outcome == 1) //xdn
@@ -148,8 +174,7 @@ public:
                 /* SIC-POVM Mapping Spin 1
                 double sq2 = std::sqrt(2.);
                 double sq6 = std::sqrt(6.);
-                double povm_outcome;
-                is >> povm_outcome;
+                double povm_outcome = outcomes->data()[position++];
                 if (povm_outcome == 0)
                     *it = site_type{(Eigen::Matrix<double, 6, 1>() <<     -sq2,     -sq6,       -2,        1,        1,        0).finished()};
                 else if (povm_outcome == 1)
@@ -176,8 +201,7 @@ public:
                 /* MUB spin 1 map
                 double s23 = std::sqrt(2./3.);
                 double f23 = std::sqrt(2.)/3.;
-                double povm_outcome;
-                is >> povm_outcome;
+                double povm_outcome = outcomes->data()[position++];
                 if (povm_outcome == 10)
                     *it = site_type{(Eigen::Matrix<double, 6, 1>() <<        0,        0,        4,        0,        0,        2).finished()};
                 else if (povm_outcome == 11)
@@ -208,6 +232,7 @@ public:
                 
             }
         }
+        sweeps += n;
     }
 
     virtual void measure() override {
@@ -215,7 +240,7 @@ public:
     }
 
     virtual double fraction_completed() const override {
-        return 0;
+        return total_sweeps > 0 ? double(sweeps) / total_sweeps : 1.;
     }
 
     using Base::save;
@@ -228,6 +253,11 @@ public:
             engine_ss << rng;
             ar["checkpoint/random"] << engine_ss.str();
         }
+        ar["checkpoint/phase_point"]
+            << std::vector<double>(ppoint.begin(), ppoint.end());
+        ar["checkpoint/group_slice"]
+            << std::vector<int>{group_slice.first, group_slice.second};
+        ar["checkpoint/sweeps"] << sweeps;
         ar["checkpoint/total_sweeps"] << total_sweeps;
         //ar["checkpoint/lattice"] << lattice;
     }
@@ -240,7 +270,20 @@ public:
             std::istringstream engine_ss(engine_str);
             engine_ss >> rng;
         }
-        //ar["checkpoint/sweeps"] >> sweeps;
+        // the data file is reopened upon the next update()
+        outcomes.reset();
+        if (ar.is_data("checkpoint/phase_point")) {
+            std::vector<double> pp;
+            ar["checkpoint/phase_point"] >> pp;
+            ppoint = phase_point(pp.begin());
+            std::vector<int> slice_vec;
+            ar["checkpoint/group_slice"] >> slice_vec;
+            group_slice = {slice_vec[0], slice_vec[1]};
+            ar["checkpoint/sweeps"] >> sweeps;
+            ar["checkpoint/total_sweeps"] >> total_sweeps;
+        } else {
+            total_sweeps = 0;
+        }
         //ar["checkpoint/lattice"] >> lattice;
     }
 
@@ -251,7 +294,6 @@ public:
 
     virtual void reset_sweeps(bool) override {
         sweeps = 0;
-        is.seekg(0);
     }
 
     bool is_thermalized() const {
@@ -278,72 +320,86 @@ public:
         return random_samples;
     }
 
+    static std::string data_file_name(std::string const& data_path,
+                                      phase_point const& pp)
+    {
+        std::stringstream ss;
+        std::string dataset;
+        ///* Access datasets through temperature parameter
+        dataset = "Run_" + std::to_string(int(pp.temperature() + 0.5));
+        //*/
+        ss << data_path << "/" << dataset << ".txt";
+        return ss.str();
+    }
+
+    // The cost of a phase point is estimated by the size of its data file,
+    // such that the largest files are dispatched first.
+    struct batcher : Base::batcher {
+        batcher(parameters_type & parameters)
+            : Base::batcher(parameters,
+                [data_path = parameters["datapath"].as<std::string>()]
+                (phase_point const& pp) -> double {
+                    std::ifstream file(data_file_name(data_path, pp),
+                                       std::ios::binary | std::ios::ate);
+                    return file ? double(file.tellg()) : 0.;
+                })
+        {
+        }
+    };
+
     virtual bool update_phase_point(phase_point const& pp) override {
-        std::mt19937 rng{};
-        bool changed = (pp != ppoint);
+        std::pair<int, int> slice{communicator.rank(), communicator.size()};
+        bool changed = (pp != ppoint || slice != group_slice);
         if (changed) {
             ppoint = pp;
-            std::string file_name = [&] {
-                std::stringstream ss;
-                std::string dataset;
-                ///* Access datasets through temperature parameter
-                dataset = "Run_" + std::to_string(int(ppoint.temperature() + 0.5));
-                //*/
-                ss << data_path << "/" << dataset << ".txt";
-                return ss.str();
-            }();
-    #pragma omp critical
-            std::clog << "opening file '" << file_name << "'\n";
-            if (is.is_open())
-                is.close();
-            is.open(file_name);
-            if (!is)
-                throw std::runtime_error("could not open file: " + file_name);
-
-            // determine line length
-            std::string first_line;
-            std::getline(is, first_line);
-            std::stringstream ss{first_line};
-            size_t n_line = std::distance(std::istream_iterator<double>{ss},
-                                          std::istream_iterator<double>{});
-
-            // determine total number of samples
-            is.seekg(0, std::ios::end);
-            total_sweeps = is.tellg() / (first_line.size() + 1) - 1;
-
-            if (is.tellg() % (first_line.size() + 1) != 0)
-    #pragma omp critical
-            {
-                std::cerr << "warning: file size not a multiple of first line\n"
-                          << "file size: " << is.tellg() << "\t1st line: "
-                          << (first_line.size() + 1) << '\n';
-            }
-            is.seekg(0);
+            group_slice = slice;
+            open_slice();
+        }
 
-            all_samples.resize(total_sweeps);
-            for (auto& lattice : all_samples) {
+        return changed;
+    }
 
-                //client-specific: Infer lattice size from line length
+private:
+    // Attaches to the outcomes of the data file of the current phase point
+    // and determines the slice of its shots to be mapped by this rank.
+    void open_slice() {
+        std::mt19937 rng{};
+        std::string file_name = data_file_name(data_path, ppoint);
+        outcomes = std::make_unique<shared_outcomes>(file_name);
+    #pragma omp critical
+        std::clog << "opened file '" << file_name << "'"
+                  << (outcomes->is_shared() ? " (shared)" : "") << '\n';
+        size_t n_line = outcomes->n_line();
+        size_t n_shots = outcomes->n_shots();
+
+        // each rank of the batch group maps a disjoint slice of the shots
+        size_t shots_begin = n_shots * group_slice.first / group_slice.second;
+        size_t shots_end = n_shots * (group_slice.first + 1) / group_slice.second;
+        total_sweeps = shots_end - shots_begin;
+        slice_begin = shots_begin * n_line;
+
+        all_samples.resize(std::min(size_t{shots_per_update}, total_sweeps));
+        for (auto& lattice : all_samples) {
 
-                // Here we randomly initialize the lattice by infering its size from
-                // the length of a line from the input data
-                // The reading of the values is done in update()
+            //client-specific: Infer lattice size from line length
 
-                ///* DIM=1 (chain)
-                lattice = {static_cast<size_t>(n_line), true, [&rng] {
-                //*/
-                    
-                /* DIM=2 N_BASIS=2 (squarelink)
-                lattice = {static_cast<size_t>(sqrt(n_line/2)), true, [&rng] {
-                */
-                    return site_type::random(rng);
-                    }};
-            }
-        }
+            // Here we randomly initialize the lattice by infering its size from
+            // the length of a line from the input data
+            // The reading of the values is done in update()
 
-        return changed;
+            ///* DIM=1 (chain)
+            lattice = {static_cast<size_t>(n_line), true, [&rng] {
+            //*/
+                
+            /* DIM=2 N_BASIS=2 (squarelink)
+            lattice = {static_cast<size_t>(sqrt(n_line/2)), true, [&rng] {
+            */
+                return site_type::random(rng);
+                }};
+        }
     }
 
+public:
 
     template <typename Introspector>
     using config_policy_type = tksvm::config::policy<lattice_type, Introspector>;
@@ -0,0 +1,83 @@
+// SVM Order Parameters for Hidden Spin Order
+// Copyright (C) 2018-2019  Jonas Greitemann, Ke Liu, and Lode Pollet
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "doctest.h"
+
+#include <vector>
+
+#include <Eigen/Eigenvalues>
+
+#include <tksvm/utilities/eigensolver.hpp>
+
+
+// graph Laplacian of two disconnected open grids of nx1 x ny1 and nx2 x ny2
+// sites, such that the lowest eigenvalue is degenerate
+tksvm::sparse_matrix_t grid_laplacian(size_t nx1, size_t ny1,
+                                      size_t nx2, size_t ny2)
+{
+    size_t n = nx1 * ny1 + nx2 * ny2;
+    std::vector<Eigen::Triplet<double>> triplets;
+    auto grid = [&](size_t offset, size_t nx, size_t ny) {
+        for (size_t x = 0; x < nx; ++x) {
+            for (size_t y = 0; y < ny; ++y) {
+                size_t i = offset + x * ny + y;
+                auto bond = [&](size_t j) {
+                    triplets.emplace_back(i, j, -1.);
+                    triplets.emplace_back(j, i, -1.);
+                    triplets.emplace_back(i, i, 1.);
+                    triplets.emplace_back(j, j, 1.);
+                };
+                if (x + 1 < nx)
+                    bond(i + ny);
+                if (y + 1 < ny)
+                    bond(i + 1);
+            }
+        }
+    };
+    grid(0, nx1, ny1);
+    grid(nx1 * ny1, nx2, ny2);
+    tksvm::sparse_matrix_t L(n, n);
+    L.setFromTriplets(triplets.begin(), triplets.end());
+    return L;
+}
+
+TEST_CASE("lowest-eigenpairs-laplacian") {
+    // large enough for the iterative solver rather than the dense fallback
+    tksvm::sparse_matrix_t L = grid_laplacian(12, 12, 10, 16);
+    size_t n_evals = 6;
+    REQUIRE(L.rows() > 200);
+
+    Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> dense{Eigen::MatrixXd(L)};
+    tksvm::eigenpairs iterative = tksvm::lowest_eigenpairs(L, n_evals);
+
+    REQUIRE(size_t(iterative.values.size()) == n_evals);
+    REQUIRE(size_t(iterative.vectors.cols()) == n_evals);
+    for (size_t k = 0; k < n_evals; ++k)
+        CHECK(iterative.values(k) == doctest::Approx(dense.eigenvalues()(k)).epsilon(1e-6));
+    CHECK(std::abs(iterative.values(1)) < 1e-6);
+
+    // eigenvectors are only determined up to rotations within degenerate
+    // subspaces: compare residuals and the spanned subspace instead
+    Eigen::MatrixXd const& V = iterative.vectors;
+    Eigen::MatrixXd R = Eigen::MatrixXd(L * V) - V * iterative.values.asDiagonal();
+    CHECK(R.colwise().norm().maxCoeff() < 1e-6);
+    CHECK((V.transpose() * V - Eigen::MatrixXd::Identity(n_evals, n_evals)).norm() < 1e-8);
+    Eigen::MatrixXd U = dense.eigenvectors().leftCols(n_evals);
+    CHECK((U.transpose() * V).jacobiSvd().singularValues().minCoeff()
+          == doctest::Approx(1.).epsilon(1e-6));
+}
@@ -0,0 +1,182 @@
+// SVM Order Parameters for Hidden Spin Order
+// Copyright (C) 2018-2019  Jonas Greitemann, Ke Liu, and Lode Pollet
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "doctest.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <dirent.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <client/shared_outcomes.hpp>
+
+
+struct data_file {
+    data_file(size_t n_shots, size_t n_line) {
+        char tmpl[] = "/tmp/Run_XXXXXX";
+        close(mkstemp(tmpl));
+        name = tmpl;
+        std::ofstream os(name);
+        // one more line than there are shots, see read_dimensions
+        for (size_t i = 0; i <= n_shots; ++i) {
+            for (size_t j = 0; j < n_line; ++j)
+                os << (i + j) % 6 << (j + 1 < n_line ? " " : "\n");
+        }
+    }
+
+    ~data_file() {
+        std::remove(name.c_str());
+    }
+
+    std::string name;
+};
+
+// names of the segments currently in /dev/shm
+std::set<std::string> segments() {
+    std::set<std::string> names;
+    if (DIR * dir = opendir("/dev/shm")) {
+        while (struct dirent * entry = readdir(dir)) {
+            std::string name = entry->d_name;
+            if (name.compare(0, 6, "qdata-") == 0)
+                names.insert("/" + name);
+        }
+        closedir(dir);
+    }
+    return names;
+}
+
+// the segment which came into existence since the given ones
+std::string new_segment(std::set<std::string> const& before) {
+    for (auto const& name : segments())
+        if (!before.count(name))
+            return name;
+    return {};
+}
+
+void check_outcomes(client::shared_outcomes const& o,
+                    size_t n_shots, size_t n_line)
+{
+    REQUIRE(o.n_shots() == n_shots);
+    REQUIRE(o.n_line() == n_line);
+    bool all_equal = true;
+    for (size_t i = 0; i < n_shots; ++i)
+        for (size_t j = 0; j < n_line; ++j)
+            all_equal &= (o.data()[i * n_line + j] == (i + j) % 6);
+    CHECK(all_equal);
+}
+
+TEST_CASE("shared-outcomes-decoding") {
+    data_file file(100, 5);
+    client::shared_outcomes o(file.name);
+    check_outcomes(o, 100, 5);
+}
+
+TEST_CASE("shared-outcomes-attach") {
+    data_file file(100, 5);
+    auto first = std::make_unique<client::shared_outcomes>(file.name);
+    if (!first->is_shared())
+        return;
+    {
+        client::shared_outcomes second(file.name);
+        CHECK(second.is_shared());
+        check_outcomes(second, 100, 5);
+    }
+    check_outcomes(*first, 100, 5);
+
+    // the segment is removed once the last one detaches, such that a change
+    // of the file is picked up
+    first.reset();
+    data_file changed(50, 7);
+    std::rename(changed.name.c_str(), file.name.c_str());
+    changed.name = file.name;
+    client::shared_outcomes third(file.name);
+    check_outcomes(third, 50, 7);
+}
+
+TEST_CASE("shared-outcomes-concurrent") {
+    data_file file(10000, 8);
+    std::vector<std::thread> threads;
+    std::vector<std::unique_ptr<client::shared_outcomes>> outcomes(8);
+    for (size_t t = 0; t < outcomes.size(); ++t)
+        threads.emplace_back([&, t] {
+            outcomes[t] = std::make_unique<client::shared_outcomes>(file.name);
+        });
+    for (auto & t : threads)
+        t.join();
+    for (auto const& o : outcomes)
+        check_outcomes(*o, 10000, 8);
+}
+
+TEST_CASE("shared-outcomes-killed-holder") {
+    data_file file(100, 5);
+    auto before = segments();
+
+    // a process which is killed while attached never detaches
+    pid_t pid = fork();
+    REQUIRE(pid >= 0);
+    if (pid == 0) {
+        new client::shared_outcomes(file.name);
+        _exit(0);
+    }
+    int status;
+    waitpid(pid, &status, 0);
+    REQUIRE(WIFEXITED(status));
+    std::string name = new_segment(before);
+    if (name.empty())
+        return;
+
+    // the segment is taken over and removed by the next process using it
+    {
+        client::shared_outcomes o(file.name);
+        CHECK(o.is_shared());
+        check_outcomes(o, 100, 5);
+        CHECK(segments().count(name) == 1);
+    }
+    CHECK(segments().count(name) == 0);
+}
+
+TEST_CASE("shared-outcomes-replaced-segment") {
+    data_file file(100, 5);
+    auto before = segments();
+    auto old_holder = std::make_unique<client::shared_outcomes>(file.name);
+    if (!old_holder->is_shared())
+        return;
+    std::string name = new_segment(before);
+    REQUIRE(!name.empty());
+
+    // the name is reused by a new segment while the old one is still held;
+    // detaching from the old one must not remove the new one
+    shm_unlink(name.c_str());
+    client::shared_outcomes new_holder(file.name);
+    CHECK(new_holder.is_shared());
+    old_holder.reset();
+    CHECK(segments().count(name) == 1);
+
+    client::shared_outcomes late(file.name);
+    CHECK(late.is_shared());
+    check_outcomes(late, 100, 5);
+}
@@ -16,9 +16,6 @@
 
 #pragma once
 
-#include <algorithm>
-#include <iterator>
-#include <limits>
 #include <random>
 #include <sstream>
 #include <string>
@@ -29,6 +26,7 @@
 #include <tksvm/phase_space/sweep.hpp>
 #include <tksvm/phase_space/classifier/policy.hpp>
 #include <tksvm/phase_space/point/common.hpp>
+#include <tksvm/phase_space/point/index.hpp>
 #include <tksvm/utilities/filesystem.hpp>
 
 
@@ -47,7 +45,7 @@ namespace classifier {
         fixed_from_sweep(alps::params const& parameters,
                          std::string const&)
         {
-            point::distance<point_type> dist;
+            std::vector<point_type> candidates;
             auto process = [&](alps::params const& parameters) {
                 auto sweep_pol = phase_space::sweep::from_parameters<point_type>(
                     parameters, "sweep.");
@@ -55,11 +53,7 @@ namespace classifier {
                 point_type p;
                 for (size_t i = 0; i < sweep_pol->size(); ++i) {
                     sweep_pol->yield(p, rng);
-                    double min_dist = std::numeric_limits<double>::max();
-                    for (auto const& pp : points)
-                        min_dist = std::min(min_dist, dist(p, pp));
-                    if (min_dist > 1e-5)
-                        points.push_back(p);
+                    candidates.push_back(p);
                 }
             };
             process(parameters);
@@ -71,15 +65,14 @@ namespace classifier {
                     process(merged_params);
                 }
             );
+            points = point::unique_points(candidates);
+            tree = point::kd_tree<point_type>(points);
         }
 
         virtual label_type operator()(point_type pp) override {
-            point::distance<point_type> dist{};
-            auto closest_it = std::min_element(points.begin(), points.end(),
-                [&](point_type const& lhs, point_type const& rhs) {
-                    return dist(lhs, pp) < dist(rhs, pp);
+            return labels(pp, [&](point_type const& p) {
+                    return label_type{static_cast<double>(tree.nearest(p))};
                 });
-            return {static_cast<double>(closest_it - points.begin())};
         }
 
         virtual std::string name(label_type const& l) const override {
@@ -95,6 +88,8 @@ namespace classifier {
         }
     private:
         std::vector<point_type> points;
+        point::kd_tree<point_type> tree;
+        point::memo<point_type, label_type> labels;
     };
 
 }
@@ -27,6 +27,7 @@
 #include <alps/params.hpp>
 
 #include <tksvm/phase_space/classifier/policy.hpp>
+#include <tksvm/phase_space/point/index.hpp>
 #include <tksvm/phase_space/point/temperature.hpp>
 #include <tksvm/utilities/polygon.hpp>
 
@@ -84,13 +85,15 @@ namespace classifier {
         }
 
         virtual label_type operator()(point_type pp) override {
-            double l = 0.;
-            for (auto const& p : pairs) {
-                if (p.second.is_inside(pp))
-                    return {l};
-                l += 1;
-            }
-            return label_type{static_cast<double>(pairs.size() + 1)};
+            return labels(pp, [&](point_type const& q) {
+                    double l = 0.;
+                    for (auto const& p : pairs) {
+                        if (p.second.is_inside(q))
+                            return label_type{l};
+                        l += 1;
+                    }
+                    return label_type{static_cast<double>(pairs.size() + 1)};
+                });
         }
 
         virtual std::string name(label_type const& l) const override {
@@ -104,6 +107,7 @@ namespace classifier {
         }
     private:
         std::vector<pair_type> pairs;
+        point::memo<point_type, label_type> labels;
     };
 
 }
@@ -0,0 +1,207 @@
+// SVM Order Parameters for Hidden Spin Order
+// Copyright (C) 2018-2019  Jonas Greitemann, Ke Liu, and Lode Pollet
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+
+namespace tksvm {
+namespace phase_space {
+namespace point {
+
+    // Static k-d tree over a set of phase points, answering nearest-point and
+    // fixed-radius queries in logarithmic time. The tree is stored implicitly
+    // in a permutation of the point indices: each range is split at its
+    // median along the axis of largest spread.
+    template <typename Point>
+    struct kd_tree {
+        using point_type = Point;
+
+        kd_tree() : dim(0) {}
+
+        kd_tree(std::vector<point_type> const& points)
+            : dim(points.empty() ? 0 : std::distance(points.front().begin(),
+                                                     points.front().end()))
+            , order(points.size())
+            , axis(points.size())
+        {
+            coords.reserve(points.size() * dim);
+            for (auto const& p : points)
+                coords.insert(coords.end(), p.begin(), p.end());
+            std::iota(order.begin(), order.end(), 0);
+            build(0, order.size());
+        }
+
+        size_t size() const {
+            return order.size();
+        }
+
+        // index of the closest point; of several equidistant ones, the first
+        size_t nearest(point_type const& p) const {
+            std::vector<double> q(p.begin(), p.end());
+            size_t best = size();
+            double best_d2 = std::numeric_limits<double>::max();
+            nearest(q.data(), 0, order.size(), best, best_d2);
+            return best;
+        }
+
+        // calls f(i) for the index of each point within distance r of p
+        template <typename F>
+        void for_each_within(point_type const& p, double r, F && f) const {
+            std::vector<double> q(p.begin(), p.end());
+            within(q.data(), r * r, 0, order.size(), f);
+        }
+
+    private:
+        double const* coord(size_t i) const {
+            return &coords[i * dim];
+        }
+
+        double distance_sq(double const* q, size_t i) const {
+            double d2 = 0;
+            for (size_t d = 0; d < dim; ++d)
+                d2 += (q[d] - coord(i)[d]) * (q[d] - coord(i)[d]);
+            return d2;
+        }
+
+        void build(size_t lo, size_t hi) {
+            if (hi - lo < 2)
+                return;
+            size_t best_axis = 0;
+            double best_spread = -1;
+            for (size_t d = 0; d < dim; ++d) {
+                auto mm = std::minmax_element(order.begin() + lo, order.begin() + hi,
+                    [&](size_t a, size_t b) { return coord(a)[d] < coord(b)[d]; });
+                double spread = coord(*mm.second)[d] - coord(*mm.first)[d];
+                if (spread > best_spread) {
+                    best_spread = spread;
+                    best_axis = d;
+                }
+            }
+            size_t mid = lo + (hi - lo) / 2;
+            std::nth_element(order.begin() + lo, order.begin() + mid,
+                             order.begin() + hi,
+                [&](size_t a, size_t b) {
+                    return coord(a)[best_axis] < coord(b)[best_axis];
+                });
+            axis[mid] = best_axis;
+            build(lo, mid);
+            build(mid + 1, hi);
+        }
+
+        void nearest(double const* q, size_t lo, size_t hi,
+                     size_t & best, double & best_d2) const
+        {
+            if (lo >= hi)
+                return;
+            size_t mid = lo + (hi - lo) / 2;
+            size_t i = order[mid];
+            double d2 = distance_sq(q, i);
+            if (d2 < best_d2 || (d2 == best_d2 && i < best)) {
+                best = i;
+                best_d2 = d2;
+            }
+            if (hi - lo == 1)
+                return;
+            double diff = q[axis[mid]] - coord(i)[axis[mid]];
+            if (diff < 0) {
+                nearest(q, lo, mid, best, best_d2);
+                if (diff * diff <= best_d2)
+                    nearest(q, mid + 1, hi, best, best_d2);
+            } else {
+                nearest(q, mid + 1, hi, best, best_d2);
+                if (diff * diff <= best_d2)
+                    nearest(q, lo, mid, best, best_d2);
+            }
+        }
+
+        template <typename F>
+        void within(double const* q, double r2, size_t lo, size_t hi, F & f) const {
+            if (lo >= hi)
+                return;
+            size_t mid = lo + (hi - lo) / 2;
+            size_t i = order[mid];
+            if (distance_sq(q, i) <= r2)
+                f(i);
+            if (hi - lo == 1)
+                return;
+            double diff = q[axis[mid]] - coord(i)[axis[mid]];
+            if (diff <= 0 || diff * diff <= r2)
+                within(q, r2, lo, mid, f);
+            if (diff >= 0 || diff * diff <= r2)
+                within(q, r2, mid + 1, hi, f);
+        }
+
+        size_t dim;
+        std::vector<double> coords;
+        std::vector<size_t> order;
+        std::vector<size_t> axis;
+    };
+
+    // The points in order of first occurrence, omitting those which lie
+    // within eps of a previously retained one.
+    template <typename Point>
+    std::vector<Point> unique_points(std::vector<Point> const& points,
+                                     double eps = 1e-5)
+    {
+        kd_tree<Point> tree(points);
+        std::vector<bool> retained(points.size(), false);
+        std::vector<Point> unique;
+        for (size_t i = 0; i < points.size(); ++i) {
+            bool duplicate = false;
+            tree.for_each_within(points[i], eps, [&](size_t j) {
+                    duplicate |= j < i && retained[j];
+                });
+            if (!duplicate) {
+                retained[i] = true;
+                unique.push_back(points[i]);
+            }
+        }
+        return unique;
+    }
+
+    // Caches a function of phase points, such as the label assigned by a
+    // classifier; samples are typically drawn from a few distinct points.
+    template <typename Point, typename Value>
+    struct memo {
+        template <typename F>
+        Value const& operator() (Point const& p, F && f) {
+            auto it = cache.find(p);
+            if (it == cache.end())
+                it = cache.emplace(p, f(p)).first;
+            return it->second;
+        }
+
+    private:
+        struct less {
+            bool operator() (Point const& lhs, Point const& rhs) const {
+                return std::lexicographical_compare(lhs.begin(), lhs.end(),
+                                                    rhs.begin(), rhs.end());
+            }
+        };
+        std::map<Point, Value, less> cache;
+    };
+
+}
+}
+}
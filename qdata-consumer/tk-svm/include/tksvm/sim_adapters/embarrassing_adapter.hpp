@@ -19,6 +19,8 @@
 #include <algorithm>
 #include <functional>
 #include <iterator>
+#include <numeric>
+#include <utility>
 #include <vector>
 
 #include <alps/mc/mcbase.hpp>
@@ -36,17 +38,25 @@ struct embarrassing_adapter : public alps::mcmpiadapter<alps::mcbase> {
     using Base = alps::mcmpiadapter<alps::mcbase>;
     using phase_point = PhasePoint;
 
+    // Each phase point makes up one batch, in the sweep order. If a cost
+    // estimate is given, order() lists the batches by decreasing cost, such
+    // that the dispatcher leaves no expensive point for the end of the run.
+    // Ties (and all batches, in the absence of an estimate) retain the sweep
+    // order. As the estimate may change between runs, the dispatcher keeps
+    // the order in its checkpoint.
     struct batcher {
         using batch_type = std::vector<phase_point>;
         using batches_type = std::vector<batch_type>;
+        using cost_function = std::function<double(phase_point const&)>;
 
         static void define_parameters(parameters_type & parameters) {
             parameters.template define<size_t>("batch.n_parallel", 0,
                 "number of parallel processes per batch (0 = optimum)");
         }
 
-        batcher(parameters_type & parameters)
+        batcher(parameters_type & parameters, cost_function cost = {})
             : n_parallel{parameters["batch.n_parallel"].template as<size_t>()}
+            , cost{std::move(cost)}
         {
         }
 
@@ -63,8 +73,24 @@ struct embarrassing_adapter : public alps::mcmpiadapter<alps::mcbase> {
             return batches;
         }
 
+        std::vector<size_t> order(batches_type const& batches) const {
+            std::vector<size_t> indices(batches.size());
+            std::iota(indices.begin(), indices.end(), 0);
+            if (cost) {
+                std::vector<double> costs;
+                for (batch_type const& batch : batches)
+                    costs.push_back(cost(batch.front()));
+                std::stable_sort(indices.begin(), indices.end(),
+                    [&costs](size_t lhs, size_t rhs) {
+                        return costs[lhs] > costs[rhs];
+                    });
+            }
+            return indices;
+        }
+
     private:
         size_t n_parallel;
+        cost_function cost;
     };
 
     static void define_parameters(parameters_type & parameters) {
@@ -78,10 +104,20 @@ struct embarrassing_adapter : public alps::mcmpiadapter<alps::mcbase> {
     {
     }
 
+    // Alternates update() and measure() until the phase point is complete,
+    // checking the stop callback in between; returns false if stopped early.
+    // The simulation is expected to process a portion of the point per
+    // update() and report its progress through fraction_completed(), such
+    // that a stopped point is resumed from its checkpoint.
     bool run(boost::function<bool ()> const & stop_callback) {
-        this->update();
-        this->measure();
-        return true;
+        bool stopped = false;
+        while (this->fraction_completed() < 1.
+               && !(stopped = stop_callback()))
+        {
+            this->update();
+            this->measure();
+        }
+        return !stopped;
     }
 
     void rebind_communicator(mpi::communicator const& comm_new) {
@@ -20,6 +20,7 @@
 #include <deque>
 #include <iterator>
 #include <sstream>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -96,6 +97,24 @@ public:
         }
     }
 
+    // The configurations are only mapped upon surrender, which requires the
+    // configuration policy; hence the simulation is restored in this case.
+    static problem_t restore_problem (parameters_type & parms,
+                                      alps::hdf5::archive & ar,
+                                      std::string const& path)
+    {
+        procrastination_adapter sim(parms);
+        ar[path] >> sim;
+        return sim.surrender_problem();
+    }
+
+    static size_t stored_problem_size (alps::hdf5::archive & ar,
+                                       std::string const& path)
+    {
+        std::string buffer_path = path + "/training/config_buffer";
+        return ar.is_data(buffer_path) ? ar.extent(buffer_path)[0] : 0;
+    }
+
     problem_t surrender_problem () {
         problem_t problem(confpol->size());
         while (!config_buffer.empty()) {
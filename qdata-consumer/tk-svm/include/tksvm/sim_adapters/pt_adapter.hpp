@@ -73,6 +73,13 @@ struct iso_batcher {
         return batches;
     }
 
+    // the batches are dispatched in order
+    std::vector<size_t> order(batches_type const& batches) const {
+        std::vector<size_t> indices(batches.size());
+        std::iota(indices.begin(), indices.end(), 0);
+        return indices;
+    }
+
 private:
     size_t index;
 };
@@ -79,12 +79,13 @@ public:
 
     virtual void measure () override {
         Simulation::measure();
-        if (has_model() && Simulation::is_thermalized() && Simulation::fraction_completed() < 1.) {
-            auto res = model(svm::dataset(confpol->configuration(Simulation::configuration())));
-            measurements()["label"] << double(res.first);
+        if (has_model() && Simulation::is_thermalized()) {
+            std::vector<double> conf = confpol->configuration(Simulation::configuration());
+            phase_label label;
+            model.predict_batch(conf.data(), 1, &label, decs.data());
+            measurements()["label"] << double(label);
 
             // measure decision functions
-            auto decs = svm::detail::container_factory<std::vector<double>>::copy(res.second);
             measurements()["SVM"] << decs;
 
             // measure decision function squares
@@ -121,6 +122,7 @@ protected:
     using Simulation::parameters;
 private:
     model_t model;
+    std::vector<double> decs;
     std::unique_ptr<config_policy_t> confpol;
 
     void load_model(std::string const& arname) {
@@ -128,6 +130,7 @@ private:
 
         svm::serialization::model_serializer<svm::hdf5_tag, model_t> serial(model);
         ar["model"] >> serial;
+        decs.resize(model.nr_classifiers());
     }
 };
 
@@ -16,9 +16,13 @@
 
 #pragma once
 
+#include <algorithm>
+#include <functional>
 #include <memory>
 #include <stdexcept>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include <alps/mc/mcbase.hpp>
 
@@ -123,7 +127,11 @@ public:
         ar["training/N_sample"] << N_sample;
 
         // state
-        //ar["training/i_sample"] << i_sample;
+        ar["training/i_sample"] << i_sample;
+        if (partial_count > 0) {
+            ar["training/partial_sum"] << partial_sum;
+            ar["training/partial_count"] << partial_count;
+        }
 
         if (problem.size() > 0)
             ar["training/problem"] << prob_serializer;
@@ -136,7 +144,13 @@ public:
         ar["training/N_sample"] >> N_sample;
 
         // state
-        //ar["training/i_sample"] >> i_sample;
+        if (ar.is_data("training/i_sample"))
+            ar["training/i_sample"] >> i_sample;
+        partial_count = 0;
+        if (ar.is_data("training/partial_count")) {
+            ar["training/partial_sum"] >> partial_sum;
+            ar["training/partial_count"] >> partial_count;
+        }
 
         if (ar.is_group("training/problem"))
             ar["training/problem"] >> prob_serializer;
@@ -146,6 +160,29 @@ public:
             throw std::runtime_error("invalid problem dimension");
     }
 
+    // Restores only the problem of the clone saved at `path`, without
+    // constructing the simulation or its configuration policy. Empty if the
+    // clone did not take any samples.
+    static problem_t restore_problem (parameters_type &,
+                                      alps::hdf5::archive & ar,
+                                      std::string const& path)
+    {
+        problem_t prob(0);
+        if (ar.is_group(path + "/training/problem")) {
+            svm::serialization::problem_serializer<svm::hdf5_tag, problem_t> serializer(prob);
+            ar[path + "/training/problem"] >> serializer;
+        }
+        return prob;
+    }
+
+    // number of samples of the clone saved at `path`, without reading them
+    static size_t stored_problem_size (alps::hdf5::archive & ar,
+                                       std::string const& path)
+    {
+        std::string labels_path = path + "/training/problem/labels";
+        return ar.is_data(labels_path) ? ar.extent(labels_path)[0] : 0;
+    }
+
     problem_t surrender_problem () {
         problem_t other_problem(confpol->size());
         std::swap(other_problem, problem);
@@ -155,42 +192,62 @@ public:
     virtual void sample_config(std::vector<typename Simulation::lattice_type> const& config,
                                phase_point const& ppoint)
     {
+        // at most sweep.samples configurations are taken per phase point,
+        // also if they are handed over in several portions; a clone may hold
+        // fewer, e.g. if the ranks of a batch group share the samples
+        size_t n = std::min(N_sample - std::min(i_sample, N_sample),
+                            config.size());
+        i_sample += n;
         if (Nc == 1) {
             #pragma omp parallel for
-            for (auto lit = config.cbegin(); lit != config.cbegin()+N_sample; ++lit) {
-                auto mapped_sample = confpol->configuration(*lit);
+            for (size_t i = 0; i < n; ++i) {
+                auto mapped_sample = confpol->configuration(config[i]);
                 #pragma omp critical
                 problem.add_sample(mapped_sample, ppoint);
             }
         }
         else if (Nc > 1) {
-            // number of constructed feature vectors will be approximaltely sweep.samples/sweep.Nc
-            // the actual number depends on number of OMP threads
-            // in general there will be at least (sweep.samples//numOMPthreads)//sweep.Nc * sweep.Nc feature vectors
-            // '//' means integer division here and '/' means proper division
+            // each feature vector is the average over sweep.Nc consecutive
+            // configurations; a group left incomplete at the end of one
+            // portion is completed by the next one
+            auto accumulate = [&](std::vector<double> & cumul_sample, size_t i) {
+                auto mapped_sample = confpol->configuration(config[i]);
+                std::transform(mapped_sample.begin(), mapped_sample.end(),
+                                cumul_sample.begin(), cumul_sample.begin(),
+                                std::plus<double>());
+            };
+            auto add_average = [&](std::vector<double> & cumul_sample) {
+                std::transform(cumul_sample.begin(), cumul_sample.end(),
+                                cumul_sample.begin(), [&](double const& a){return a/Nc;});
+                #pragma omp critical
+                problem.add_sample(cumul_sample, ppoint);
+                cumul_sample.assign(cumul_sample.size(), 0.);
+            };
+
+            size_t i = 0;
+            partial_sum.resize(confpol->size(), 0.);
+            for (; partial_count > 0 && i < n; ++i) {
+                accumulate(partial_sum, i);
+                if (++partial_count == Nc) {
+                    add_average(partial_sum);
+                    partial_count = 0;
+                }
+            }
+
+            size_t n_groups = (n - i) / Nc;
             #pragma omp parallel
             {
-                size_t sample_counter = 0;
                 std::vector<double> cumul_sample(confpol->size(), 0.);
                 #pragma omp for
-                for (auto lit = config.cbegin(); lit != config.cbegin()+N_sample; ++lit) {
-                    auto mapped_sample = confpol->configuration(*lit);
-                    std::transform(mapped_sample.begin(), mapped_sample.end(),
-                                    cumul_sample.begin(), cumul_sample.begin(),
-                                    std::plus<double>());
-                    ++sample_counter;
-                    if (sample_counter % Nc == 0) {
-                        std::transform(cumul_sample.begin(), cumul_sample.end(),
-                                        cumul_sample.begin(), [&](double const& a){return a/Nc;});
-
-                        #pragma omp critical
-                        {
-                            problem.add_sample(cumul_sample, ppoint);
-                        }
-                        cumul_sample.assign(cumul_sample.size(), 0.);
-                    }
+                for (size_t g = 0; g < n_groups; ++g) {
+                    for (size_t k = 0; k < Nc; ++k)
+                        accumulate(cumul_sample, i + g * Nc + k);
+                    add_average(cumul_sample);
                 }
             }
+
+            for (i += n_groups * Nc; i < n; ++i, ++partial_count)
+                accumulate(partial_sum, i);
         }
         else
             throw std::runtime_error("sample_config(): parameter sweep.Nc must be >= 1");
@@ -198,7 +255,9 @@ public:
 
     void reset_sweeps(bool skip_therm = false) override {
         Simulation::reset_sweeps(skip_therm);
-        //i_sample = 0;
+        i_sample = 0;
+        partial_count = 0;
+        partial_sum.assign(partial_sum.size(), 0.);
     }
 
 protected:
@@ -210,7 +269,12 @@ private:
 
     size_t N_sample;
     size_t Nc;
-    //size_t i_sample = 0;
+
+    // configurations taken at the current phase point and the sum over those
+    // of an incomplete group of sweep.Nc
+    size_t i_sample = 0;
+    std::vector<double> partial_sum;
+    size_t partial_count = 0;
 
     problem_t problem;
     svm::serialization::problem_serializer<svm::hdf5_tag, problem_t> prob_serializer;
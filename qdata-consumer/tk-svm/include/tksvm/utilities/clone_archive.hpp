@@ -0,0 +1,96 @@
+// SVM Order Parameters for Hidden Spin Order
+// Copyright (C) 2018-2019  Jonas Greitemann, Ke Liu, and Lode Pollet
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+
+#include <alps/hdf5/archive.hpp>
+
+#include <tksvm/utilities/filesystem.hpp>
+
+
+namespace tksvm {
+
+// Layout of the clones in a checkpoint file: clone 0 is stored in the
+// checkpoint file itself, all other clones in shard files alongside it, such
+// that all ranks may write their checkpoints concurrently. The checkpoint file
+// holds the number of clones and the shard file names, relative to its own
+// directory, as an index. Checkpoint files which contain all clones themselves
+// (as written before) lack the index and are read as such.
+namespace clone_archive {
+
+    // path of the clone within the file it is stored in
+    inline std::string path(size_t tid) {
+        return "simulation/clones/" + std::to_string(tid);
+    }
+
+    inline std::string index_path(size_t tid) {
+        return "simulation/clone_files/" + std::to_string(tid);
+    }
+
+    // name of the file the clone is written to
+    inline std::string file_name(std::string const& checkpoint_file, size_t tid) {
+        if (tid == 0)
+            return checkpoint_file;
+        return replace_extension(checkpoint_file,
+            ".clone." + std::to_string(tid) + ".h5");
+    }
+
+    inline std::string directory(std::string const& file) {
+        size_t pos = file.find_last_of('/');
+        return pos == std::string::npos ? std::string{} : file.substr(0, pos + 1);
+    }
+
+    // to be written to the checkpoint file by the clone 0
+    inline void write_index(alps::hdf5::archive & ar,
+                            std::string const& checkpoint_file,
+                            int n_clones)
+    {
+        ar["simulation/n_clones"] << n_clones;
+        size_t prefix = directory(checkpoint_file).size();
+        for (int tid = 1; tid < n_clones; ++tid)
+            ar[index_path(tid)] << file_name(checkpoint_file, tid).substr(prefix);
+    }
+
+    // name of the shard file holding the clone according to the index, or
+    // empty if the clone is stored in the archive itself
+    inline std::string find_shard(alps::hdf5::archive & ar, size_t tid) {
+        if (!ar.is_data(index_path(tid)))
+            return {};
+        std::string name;
+        ar[index_path(tid)] >> name;
+        return directory(ar.get_filename()) + name;
+    }
+
+    // calls f(clone_ar, path) with the archive holding the clone
+    template <typename Function>
+    auto with_clone(alps::hdf5::archive & ar, size_t tid, Function && f)
+        -> decltype(f(ar, path(tid)))
+    {
+        std::string name = find_shard(ar, tid);
+        if (name.empty())
+            return f(ar, path(tid));
+        alps::hdf5::archive clone_ar(name, "r");
+        if (!clone_ar.is_open())
+            throw std::runtime_error("Unable to open archive: " + name);
+        return f(clone_ar, path(tid));
+    }
+
+}
+}
@@ -36,6 +36,8 @@ inline alps::params& define_convenience_parameters(alps::params & parameters) {
         .define<std::string>("checkpoint",
                              replace_extension(origin, ".clone.h5"),
                              "name of the checkpoint file to save to")
+        .define<bool>("compress", false,
+                      "compress the datasets written to the checkpoint file")
         ;
     return parameters;
 }
@@ -0,0 +1,43 @@
+// SVM Order Parameters for Hidden Spin Order
+// Copyright (C) 2018-2019  Jonas Greitemann, Ke Liu, and Lode Pollet
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstddef>
+
+#include <Eigen/Dense>
+#include <Eigen/SparseCore>
+
+
+namespace tksvm {
+
+using sparse_matrix_t = Eigen::SparseMatrix<double>;
+
+struct eigenpairs {
+    Eigen::VectorXd values;     // ascending
+    Eigen::MatrixXd vectors;    // corresponding eigenvectors as columns
+};
+
+// The n_evals lowest eigenpairs of the symmetric positive semi-definite
+// sparse matrix A, e.g. a graph Laplacian. Uses a block Lanczos iteration
+// on the shift-inverted operator (A + sigma)^-1 with Rayleigh-Ritz
+// projection onto A, such that degenerate eigenvalues (disconnected
+// components) are resolved up to the block size. Small problems are
+// diagonalized densely.
+eigenpairs lowest_eigenpairs(sparse_matrix_t const& A, size_t n_evals,
+                             double tol = 1e-8);
+
+}
@@ -17,7 +17,9 @@
 #pragma once
 
 #include <algorithm>
+#include <iostream>
 #include <regex>
+#include <sstream>
 #include <string>
 #include <fstream>
 
@@ -0,0 +1,87 @@
+// SVM Order Parameters for Hidden Spin Order
+// Copyright (C) 2018-2019  Jonas Greitemann, Ke Liu, and Lode Pollet
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+
+#include <svm/dataset.hpp>
+#include <svm/traits/label_traits.hpp>
+
+#include <tksvm/utilities/mpi/mpi.hpp>
+
+
+namespace tksvm {
+namespace mpi {
+
+    // Concatenates the problems of all processes of a communicator in the
+    // order of their ranks, such that every process ends up with the same
+    // problem. Each process broadcasts its samples in turn, in blocks of rows
+    // (as the HDF5 problem serializer writes them), such that only one block
+    // is held densely at a time and the counts stay within the MPI limit.
+    template <class Problem>
+    Problem all_gather_problem(communicator const& comm, Problem const& local) {
+        using input_t = typename Problem::input_container_type;
+        using label_t = typename Problem::label_type;
+        using ltraits = typename ::svm::traits::label_traits<label_t>;
+        using view_t = typename std::conditional<
+            std::is_same<svm::dataset, input_t>::value,
+            svm::data_view, input_t const&>::type;
+
+        size_t dim = local.dim(), ldim = ltraits::label_dim;
+        std::vector<unsigned long> sizes(comm.size());
+        unsigned long n = local.size();
+        all_gather(comm, &n, 1, sizes.data(), 1);
+
+        Problem prob(dim);
+        unsigned long n_total = 0;
+        for (unsigned long s : sizes)
+            n_total += s;
+        prob.reserve(n_total);
+
+        size_t rows = std::max<size_t>(1,
+            (size_t(1) << 20) / std::max<size_t>(dim, 1));
+        std::vector<double> data(rows * dim);
+        std::vector<double> labels(rows * ldim);
+        for (int r = 0; r < comm.size(); ++r) {
+            for (size_t i0 = 0; i0 < sizes[r]; i0 += rows) {
+                size_t nb = std::min<size_t>(rows, sizes[r] - i0);
+                if (r == comm.rank()) {
+                    std::fill(data.begin(), data.end(), 0.);
+                    for (size_t i = 0; i < nb; ++i) {
+                        auto p = local[i0 + i];
+                        view_t xs = p.first;
+                        label_t const& l = p.second;
+                        std::copy(xs.begin(), xs.end(), &data[i * dim]);
+                        std::copy(ltraits::begin(l), ltraits::end(l),
+                            &labels[i * ldim]);
+                    }
+                }
+                broadcast(comm, data.data(), nb * dim, r);
+                broadcast(comm, labels.data(), nb * ldim, r);
+                for (size_t i = 0; i < nb; ++i)
+                    prob.add_sample(input_t(&data[i * dim],
+                                            &data[(i + 1) * dim]),
+                                    ltraits::from_iterator(&labels[i * ldim]));
+            }
+        }
+        return prob;
+    }
+
+}
+}
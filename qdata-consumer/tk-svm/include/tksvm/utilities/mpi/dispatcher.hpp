@@ -17,9 +17,10 @@
 #pragma once
 
 #include <algorithm>
-#include <chrono>
+#include <deque>
 #include <functional>
 #include <mutex>
+#include <numeric>
 #include <sstream>
 #include <stdexcept>
 #include <string>
@@ -29,6 +30,7 @@
 
 #include <alps/hdf5/archive.hpp>
 
+#include <tksvm/utilities/clone_archive.hpp>
 #include <tksvm/utilities/mpi/mpi.hpp>
 
 
@@ -49,12 +51,19 @@ private:
 	static constexpr int report_idle_tag = 42;
 	static constexpr int request_batch_tag = 43;
 
+	// number of batch indices requested by a group ahead of time, such that
+	// the next one is usually at hand once the current batch is finished
+	static constexpr size_t lookahead = 2;
+
+	// payload of the final message of a group leader to the master
+	static constexpr int leader_done = -2;
+
 	mpi::communicator comm_world;
 
 public:
 	const std::string checkpoint_file;
+	const std::string checkpoint_mode;
 	const bool resumed;
-	size_t session_counter = 0;
 	const BatchesContainer batches;
 	const size_t batch_size = std::max_element(batches.begin(), batches.end(),
 		[](batch_type const& lhs, batch_type const& rhs) {
@@ -69,7 +78,22 @@ public:
 
 private:
 	mpi::mutex & archive_mutex;
+
+	// indices of the batches in the order they are handed out; all other
+	// batch indices, including those in the checkpoint, refer to batches
+	std::vector<size_t> order;
+
 	int batch_int;
+	bool batch_resumed = false;
+
+	// replies of the master to outstanding requests of the group leader:
+	// the batch index (or -1) and whether the batch is to be resumed
+	struct pending_reply {
+		int reply[2];
+		MPI_Request request;
+	};
+	std::deque<pending_reply> pending_replies;
+	bool requested = false;
 
 	stop_callback_type stop_cb;
 	checkpoint_callback_type write_cb;
@@ -80,26 +104,33 @@ public:
 		mpi::mutex & archive_mutex,
 		bool resumed,
 		BatchesContainer && batches,
+		std::vector<size_t> && order,
 		stop_callback_type && stop_cb,
 		checkpoint_callback_type const& read_cb,
-		checkpoint_callback_type && write_cb)
+		checkpoint_callback_type && write_cb,
+		bool compress_checkpoint = false)
 	: checkpoint_file{checkpoint_file}
+	, checkpoint_mode{compress_checkpoint ? "wc" : "w"}
 	, resumed{resumed}
 	, batches{std::forward<BatchesContainer>(batches)}
     , archive_mutex{archive_mutex}
+	, order{std::move(order)}
 	, stop_cb{std::move(stop_cb)}
 	, write_cb{std::move(write_cb)}
 	{
         if (resumed) {
-            std::string checkpoint_path = [&] {
-                std::stringstream ss;
-                ss << "simulation/clones/" << comm_world.rank();
-                return ss.str();
-            } ();
-            {
+            size_t rank = comm_world.rank();
+            std::string shard_file = [&] {
             	std::lock_guard<mpi::mutex> archive_lock(archive_mutex);
                 alps::hdf5::archive cp(checkpoint_file, "r");
-                read_cb(cp[checkpoint_path]);
+                std::string name = clone_archive::find_shard(cp, rank);
+                if (name.empty())
+                    read_cb(cp[clone_archive::path(rank)]);
+                return name;
+            }();
+            if (!shard_file.empty()) {
+                alps::hdf5::archive cp(shard_file, "r");
+                read_cb(cp[clone_archive::path(rank)]);
             }
         }
 
@@ -114,31 +145,57 @@ public:
 	dispatcher& operator=(dispatcher &&) = delete;
 
 	~dispatcher() {
-        std::string checkpoint_path = [&] {
-            std::stringstream ss;
-            ss << "simulation/clones/" << comm_world.rank();
-            return ss.str();
-        } ();
-
         if (is_master)
         	background_thread.join();
 
-        {
+        // each clone writes to its own file, only the master's shares the
+        // checkpoint file with the index and the dispatcher state
+        size_t rank = comm_world.rank();
+        if (is_master) {
         	std::lock_guard<mpi::mutex> archive_lock(archive_mutex);
-            alps::hdf5::archive cp(checkpoint_file, "w");
-            cp["simulation/n_clones"] << comm_world.size();
-            write_cb(cp[checkpoint_path]);
+            alps::hdf5::archive cp(checkpoint_file, checkpoint_mode);
+            clone_archive::write_index(cp, checkpoint_file, comm_world.size());
+            write_cb(cp[clone_archive::path(rank)]);
+        } else {
+            alps::hdf5::archive cp(
+                clone_archive::file_name(checkpoint_file, rank),
+                checkpoint_mode);
+            write_cb(cp[clone_archive::path(rank)]);
         }
 	}
 
+	// Each group leader reports the start of a batch to the master, which
+	// serves as a request for another batch index, such that `lookahead`
+	// requests are outstanding while the group is working; the master
+	// answers them in order. Once it answers with -1 (or the leader stops),
+	// the leader collects the remaining replies and signs off.
 	bool request_batch() {
-        if (is_group_leader) {
-            mpi::send(comm_world, 0, report_idle_tag);
-            mpi::receive(comm_world, batch_int, 0, request_batch_tag);
-        }
-        mpi::broadcast(comm_group, batch_int, 0);
-        ++session_counter;
-        return batch_int >= 0;
+		int reply[2] = {-1, 0};
+		if (is_group_leader) {
+			if (!requested) {
+				for (size_t i = 0; i < lookahead; ++i)
+					post_request(-1);
+				requested = true;
+			}
+			if (!stop_cb()) {
+				MPI_Wait(&pending_replies.front().request, MPI_STATUS_IGNORE);
+				std::copy_n(pending_replies.front().reply, 2, reply);
+				pending_replies.pop_front();
+			}
+			if (reply[0] >= 0) {
+				post_request(reply[0]);
+			} else {
+				for (auto & p : pending_replies)
+					MPI_Wait(&p.request, MPI_STATUS_IGNORE);
+				pending_replies.clear();
+				int done = leader_done;
+				MPI_Send(&done, 1, MPI_INT, 0, report_idle_tag, comm_world);
+			}
+		}
+		mpi::broadcast(comm_group, reply, 2, 0);
+		batch_int = reply[0];
+		batch_resumed = reply[1];
+		return batch_int >= 0;
 	}
 
 	bool valid() const {
@@ -147,7 +204,7 @@ public:
 	}
 
 	bool point_resumed() const {
-		return resumed && session_counter <= 1;
+		return batch_resumed;
 	}
 
 	size_t batch_index() const {
@@ -159,64 +216,128 @@ public:
 	}
 
 private:
-	void dispatch_job() {
-        size_t batch_index = 0;
-        std::vector<size_t> active_batches;
-        std::vector<bool> to_resume_flag;
-        if (resumed) {
-            {
-            	std::lock_guard<mpi::mutex> archive_lock(archive_mutex);
-                alps::hdf5::archive cp(checkpoint_file, "r");
-                cp["simulation/active_batches"] >> active_batches;
-            }
-            if (n_group != active_batches.size()) {
-                throw std::runtime_error(
-                    "number of groups mustn't change on resumption");
-            }
-            to_resume_flag.resize(n_group + 1, true);
-            to_resume_flag[n_group] = false;
-            batch_index = *std::max_element(active_batches.begin(),
-                active_batches.end()) + 1;
-        } else {
-            active_batches.resize(n_group);
-            to_resume_flag.resize(n_group + 1, false);
-        }
-
-        // dispatch batches until exhausted or stopped
-        size_t n_cleanup = n_group + (comm_world.size() % batch_size != 0);
-        while (n_cleanup > 0) {
-            int idle = mpi::spin_receive(comm_world, MPI_ANY_SOURCE,
-                report_idle_tag, [&] {
-                    std::this_thread::sleep_for(
-                        std::chrono::milliseconds(100));
-                });
-            size_t idle_group = idle / batch_size;
-            if (to_resume_flag[idle_group]) {
-                // tell group to resume its active batch
-                mpi::send(comm_world,
-                    static_cast<int>(active_batches[idle]),
-                    idle, request_batch_tag);
-                to_resume_flag[idle] = false;
-            } else if (stop_cb() || batch_index >= batches.size()
-            	|| idle_group == n_group)
-            {
-                mpi::send(comm_world, -1, idle, request_batch_tag);
-                --n_cleanup;
-            } else {
-                // dispatch a new batch
-                mpi::send(comm_world,
-                    static_cast<int>(batch_index),
-                    idle, request_batch_tag);
-                active_batches[idle_group] = batch_index;
-                ++batch_index;
-            }
-        }
+	void post_request(int started_batch) {
+		pending_replies.emplace_back();
+		MPI_Irecv(pending_replies.back().reply, 2, MPI_INT, 0,
+			request_batch_tag, comm_world, &pending_replies.back().request);
+		MPI_Send(&started_batch, 1, MPI_INT, 0, report_idle_tag, comm_world);
+	}
 
-        {
-        	std::lock_guard<mpi::mutex> archive_lock(archive_mutex);
-        	alps::hdf5::archive cp(checkpoint_file, "w");
-        	cp["simulation/active_batches"] << active_batches;
-        }
+	void dispatch_job() {
+		// groups resume the batch they were working on when stopped; batches
+		// which were handed out, but not yet started, are dispatched anew.
+		// The order is that of the interrupted run, as the one passed in may
+		// have changed since (e.g. with the cost estimate of the batches).
+		size_t batch_index = 0;
+		std::vector<int> active_batches(n_group, -1);
+		std::deque<int> unstarted_batches;
+		std::vector<bool> to_resume_flag(n_group, false);
+		if (resumed) {
+			std::vector<int> unstarted;
+			{
+				std::lock_guard<mpi::mutex> archive_lock(archive_mutex);
+				alps::hdf5::archive cp(checkpoint_file, "r");
+				cp["simulation/active_batches"] >> active_batches;
+				if (cp.is_data("simulation/next_batch")) {
+					cp["simulation/next_batch"] >> batch_index;
+					cp["simulation/unstarted_batches"] >> unstarted;
+				} else {
+					batch_index = *std::max_element(active_batches.begin(),
+						active_batches.end()) + 1;
+				}
+				// checkpoints without the order were dispatched in sweep order
+				if (cp.is_data("simulation/batch_order")) {
+					cp["simulation/batch_order"] >> order;
+				} else {
+					order.resize(batches.size());
+					std::iota(order.begin(), order.end(), 0);
+				}
+			}
+			if (n_group != active_batches.size()) {
+				throw std::runtime_error(
+					"number of groups mustn't change on resumption");
+			}
+			if (order.size() != batches.size()) {
+				throw std::runtime_error(
+					"number of batches mustn't change on resumption");
+			}
+			unstarted_batches.assign(unstarted.begin(), unstarted.end());
+			for (size_t g = 0; g < n_group; ++g)
+				to_resume_flag[g] = active_batches[g] >= 0;
+		}
+
+		// one persistent receive per group leader, including the one of the
+		// incomplete group of left-over ranks, if any, which is turned away
+		size_t n_leaders = n_group + (comm_world.size() % batch_size != 0);
+		std::vector<int> started(n_leaders);
+		std::vector<MPI_Request> requests(n_leaders);
+		for (size_t g = 0; g < n_leaders; ++g)
+			MPI_Recv_init(&started[g], 1, MPI_INT, g * batch_size,
+				report_idle_tag, comm_world, &requests[g]);
+		MPI_Startall(n_leaders, requests.data());
+
+		std::vector<std::deque<int>> handed_out(n_group);
+		std::vector<bool> closed(n_leaders, false);
+		size_t n_remaining = n_leaders;
+		while (n_remaining > 0) {
+			int g;
+			MPI_Waitany(n_leaders, requests.data(), &g, MPI_STATUS_IGNORE);
+			if (started[g] == leader_done) {
+				--n_remaining;
+				continue;
+			}
+			if (started[g] >= 0) {
+				auto & queue = handed_out[g];
+				auto it = std::find(queue.begin(), queue.end(), started[g]);
+				if (it != queue.end())
+					queue.erase(it);
+				active_batches[g] = started[g];
+			}
+
+			int reply[2] = {-1, 0};
+			if (!closed[g] && size_t(g) < n_group && !stop_cb()) {
+				if (to_resume_flag[g]) {
+					reply[0] = active_batches[g];
+					reply[1] = 1;
+					to_resume_flag[g] = false;
+				} else if (!unstarted_batches.empty()) {
+					reply[0] = unstarted_batches.front();
+					unstarted_batches.pop_front();
+				} else if (batch_index < batches.size()) {
+					reply[0] = order[batch_index++];
+				}
+			}
+			if (reply[0] >= 0)
+				handed_out[g].push_back(reply[0]);
+			else
+				closed[g] = true;
+			MPI_Send(reply, 2, MPI_INT, g * batch_size, request_batch_tag,
+				comm_world);
+			MPI_Start(&requests[g]);
+		}
+		for (auto & request : requests)
+			MPI_Request_free(&request);
+
+		std::vector<int> unstarted(unstarted_batches.begin(),
+			unstarted_batches.end());
+		for (auto const& queue : handed_out)
+			unstarted.insert(unstarted.end(), queue.begin(), queue.end());
+		std::vector<size_t> position(batches.size());
+		for (size_t k = 0; k < order.size(); ++k)
+			position[order[k]] = k;
+		std::sort(unstarted.begin(), unstarted.end(),
+			[&position](int lhs, int rhs) {
+				return position[lhs] < position[rhs];
+			});
+
+		{
+			std::lock_guard<mpi::mutex> archive_lock(archive_mutex);
+			alps::hdf5::archive cp(checkpoint_file, checkpoint_mode);
+			cp["simulation/active_batches"] << active_batches;
+			cp["simulation/unstarted_batches"] << unstarted;
+			cp["simulation/next_batch"] << batch_index;
+			cp["simulation/batch_order"] << order;
+		}
 	}
 };
 
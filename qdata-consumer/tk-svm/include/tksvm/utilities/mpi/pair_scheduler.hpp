@@ -0,0 +1,121 @@
+// SVM Order Parameters for Hidden Spin Order
+// Copyright (C) 2018-2019  Jonas Greitemann, Ke Liu, and Lode Pollet
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <climits>
+#include <cstdlib>
+#include <stdexcept>
+#include <vector>
+
+#include <svm/libsvm/svm.h>
+
+#include <tksvm/utilities/mpi/mpi.hpp>
+
+
+namespace tksvm {
+namespace mpi {
+
+    // Distributes the pairs of a one-vs-one multiclassification among the
+    // processes of a communicator, each of which holds the same problem. The
+    // tickets are drawn from a counter in an RMA window on rank 0, such that
+    // processes which finish their pairs early take on more of them. Once
+    // all pairs are solved, the solutions are gathered by every process.
+    struct pair_scheduler {
+        pair_scheduler(communicator const& comm)
+            : comm{comm}
+        {
+            MPI_Win_allocate(comm.rank() == 0 ? sizeof(int) : 0, sizeof(int),
+                MPI_INFO_NULL, comm, &counter, &window);
+            reset();
+            barrier(comm);
+
+            scheduler.context = this;
+            scheduler.next = &next;
+            scheduler.gather = &gather;
+        }
+
+        pair_scheduler(pair_scheduler const&) = delete;
+        pair_scheduler& operator=(pair_scheduler const&) = delete;
+        pair_scheduler(pair_scheduler &&) = delete;
+        pair_scheduler& operator=(pair_scheduler &&) = delete;
+
+        ~pair_scheduler() {
+            MPI_Win_free(&window);
+        }
+
+        struct svm_pair_scheduler const* get() const {
+            return &scheduler;
+        }
+
+    private:
+        static int next(void * context) {
+            auto & self = *static_cast<pair_scheduler *>(context);
+            int one = 1, ticket;
+            MPI_Win_lock(MPI_LOCK_SHARED, 0, 0, self.window);
+            MPI_Fetch_and_op(&one, &ticket, MPI_INT, 0, 0, MPI_SUM,
+                self.window);
+            MPI_Win_unlock(0, self.window);
+            return ticket;
+        }
+
+        static double * gather(void * context,
+            const double * local,
+            long int n,
+            long int * total)
+        {
+            auto & self = *static_cast<pair_scheduler *>(context);
+            std::vector<long int> counts(self.comm.size());
+            all_gather(self.comm, &n, 1, counts.data(), 1);
+            std::vector<int> recv_counts(counts.size());
+            std::vector<int> displ(counts.size());
+            *total = 0;
+            for (size_t i = 0; i < counts.size(); ++i) {
+                if (*total + counts[i] > INT_MAX)
+                    throw std::runtime_error(
+                        "solutions of the pairs exceed the MPI count limit");
+                displ[i] = *total;
+                recv_counts[i] = counts[i];
+                *total += counts[i];
+            }
+            double * all = static_cast<double *>(
+                malloc(sizeof(double) * *total));
+            MPI_Allgatherv(local, n, MPI_DOUBLE, all, recv_counts.data(),
+                displ.data(), MPI_DOUBLE, self.comm);
+
+            // all tickets have been drawn; start over for the next training
+            self.reset();
+            barrier(self.comm);
+            return all;
+        }
+
+        void reset() {
+            if (comm.rank() != 0)
+                return;
+            MPI_Win_lock(MPI_LOCK_EXCLUSIVE, 0, 0, window);
+            *counter = 0;
+            MPI_Win_unlock(0, window);
+        }
+
+        communicator const& comm;
+        int * counter;
+        MPI_Win window;
+        struct svm_pair_scheduler scheduler;
+    };
+
+}
+}
@@ -0,0 +1,102 @@
+// SVM Order Parameters for Hidden Spin Order
+// Copyright (C) 2018-2019  Jonas Greitemann, Ke Liu, and Lode Pollet
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+
+namespace tksvm {
+
+// Produces the items produce(0), ..., produce(n-1) on a background thread,
+// staying at most `depth` items ahead of the consumer, which retrieves them in
+// order by calling next(). Exceptions thrown by the producer are rethrown by
+// next().
+template <typename T>
+class prefetcher {
+public:
+    template <typename Producer>
+    prefetcher(size_t n, Producer produce, size_t depth = 2)
+        : depth{depth}
+    {
+        thread = std::thread{[this, n, produce]() mutable {
+            try {
+                for (size_t i = 0; i < n; ++i) {
+                    T item = produce(i);
+                    std::unique_lock<std::mutex> lock(mutex);
+                    cv.wait(lock, [&] {
+                        return aborted || queue.size() < this->depth;
+                    });
+                    if (aborted)
+                        break;
+                    queue.push_back(std::move(item));
+                    cv.notify_all();
+                }
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex);
+                error = std::current_exception();
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            finished = true;
+            cv.notify_all();
+        }};
+    }
+
+    prefetcher(prefetcher const&) = delete;
+    prefetcher& operator=(prefetcher const&) = delete;
+
+    ~prefetcher() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            aborted = true;
+            cv.notify_all();
+        }
+        thread.join();
+    }
+
+    // waits for the next item; returns false once all items are consumed
+    bool next(T & item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [&] { return !queue.empty() || finished; });
+        if (queue.empty()) {
+            if (error)
+                std::rethrow_exception(error);
+            return false;
+        }
+        item = std::move(queue.front());
+        queue.pop_front();
+        cv.notify_all();
+        return true;
+    }
+
+private:
+    const size_t depth;
+    std::deque<T> queue;
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool aborted = false;
+    bool finished = false;
+    std::exception_ptr error;
+    std::thread thread;
+};
+
+}
@@ -89,11 +89,9 @@ int main(int argc, char** argv) {
             ar["model"] >> serial;
         }
 
-        auto treat_transition = [&] (classifier_t const& classifier,
+        auto treat_transition = [&] (double const* weights,
                                      std::string const& basename)
         {
-            introspec_t coeff = svm::linear_introspect(classifier);
-
             auto confpol = sim_base::config_policy_from_parameters<introspec_t>(
                 parameters,
                 cmdl[{"-u", "--unsymmetrize"}]);
@@ -105,11 +103,7 @@ int main(int argc, char** argv) {
 
             log_msg("Allocating coeffs...");
             boost::multi_array<double,1> coeffs(boost::extents[model.dim()]);
-            log_msg("Filling coeffs...");
-#pragma omp parallel for
-            for (size_t i = 0; i < model.dim(); ++i) {
-                coeffs[i] = coeff.coefficient(i);
-            }
+            std::copy(weights, weights + model.dim(), coeffs.begin());
             std::vector<block_ind_t> block_inds_vec(block_inds.begin(),
                                                     block_inds.end());
 
@@ -122,6 +116,8 @@ int main(int argc, char** argv) {
 
         // Determine requested transitions
         auto transitions = model.classifiers();
+        std::vector<classifier_t> requested;
+        std::vector<std::string> basenames;
         size_t t;
         bool exclusive = bool(cmdl({"-t", "--transition"}) >> t);
         for (size_t k = 0; k < transitions.size(); ++k) {
@@ -136,8 +132,18 @@ int main(int argc, char** argv) {
             ss << replace_extension(arname, "")
                << '-' << phase_classifier->name(cl.labels().first)
                << '-' << phase_classifier->name(cl.labels().second);
-            if (!cmdl[{"-l", "--list"}])
-                treat_transition(cl, ss.str());
+            if (!cmdl[{"-l", "--list"}]) {
+                requested.push_back(cl);
+                basenames.push_back(ss.str());
+            }
+        }
+
+        // coefficients of all requested transitions at once
+        if (!requested.empty()) {
+            log_msg("Filling coeffs...");
+            std::vector<double> weights = svm::linear_coefficients(model, requested);
+            for (size_t k = 0; k < requested.size(); ++k)
+                treat_transition(weights.data() + k * model.dim(), basenames[k]);
         }
 
         return 0;
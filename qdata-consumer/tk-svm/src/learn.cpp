@@ -14,28 +14,38 @@
 // You should have received a copy of the GNU General Public License
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
+#include <algorithm>
 #include <iostream>
 #include <exception>
+#include <iterator>
 #include <map>
+#include <random>
 #include <sstream>
 #include <stdexcept>
 #include <string>
 #include <tuple>
 #include <utility>
+#include <vector>
 
 #include <argh.h>
 
 #include <alps/hdf5.hpp>
 #include <alps/params.hpp>
+#include <alps/mc/stop_callback.hpp>
 
 #include <svm/svm.hpp>
 #include <svm/serialization/hdf5.hpp>
 
 #include <tksvm/config_sim_base.hpp>
 #include <tksvm/phase_space/classifier.hpp>
+#include <tksvm/phase_space/sweep.hpp>
 #include <tksvm/sim_adapters/test_adapter.hpp>
+#include <tksvm/utilities/clone_archive.hpp>
 #include <tksvm/utilities/filesystem.hpp>
+#include <tksvm/utilities/mpi/all_gather_problem.hpp>
 #include <tksvm/utilities/mpi/mpi.hpp>
+#include <tksvm/utilities/mpi/pair_scheduler.hpp>
+#include <tksvm/utilities/prefetcher.hpp>
 
 #ifdef CONFIG_MAPPING_LAZY
 #include <tksvm/sim_adapters/procrastination_adapter.hpp>
@@ -57,6 +67,7 @@ using problem_t = typename model_t::problem_t;
 int main(int argc, char** argv)
 {
     mpi::environment env(argc, argv, mpi::environment::threading::multiple);
+    mpi::communicator comm_world;
     try {
         // Creates the parameters for the simulation
         // If an hdf5 file is supplied, reads the parameters there
@@ -94,6 +105,23 @@ int main(int argc, char** argv)
         auto classifier = phase_space::classifier::from_parameters<phase_point>(
             parameters, "classifier.");
 
+        // classifies the samples of a clone and appends them to the problem
+        using clone_problem_t = typename sim_type::problem_t;
+        auto valid = [size = classifier->size()](label_t const& l) {
+            return size_t(l) <= size;
+        };
+        auto append_samples = [&](clone_problem_t && clone_problem,
+                                  size_t n_samples)
+        {
+            if (prob.dim() == 0) {
+                prob = problem_t(clone_problem.dim());
+                prob.reserve(n_samples);
+            }
+            prob.append_problem(std::move(clone_problem),
+                classifier->get_functor(),
+                valid);
+        };
+
         auto process_archive = [&](alps::hdf5::archive & cp) {
             if (!cp.is_open())
                 throw std::runtime_error(
@@ -101,37 +129,104 @@ int main(int argc, char** argv)
             int n_clones;
             cp["simulation/n_clones"] >> n_clones;
 
+            // preallocate for the samples of all clones
+            size_t n_samples = prob.size();
+            for (int tid = 0; tid < n_clones; ++tid)
+                n_samples += clone_archive::with_clone(cp, tid,
+                    &sim_type::stored_problem_size);
+            prob.reserve(n_samples);
+
+            // the problem of the next clone is read from the archive while
+            // the previous one is being classified
+            prefetcher<clone_problem_t> clone_problems(n_clones,
+                [&](size_t tid) {
+                    return clone_archive::with_clone(cp, tid,
+                        [&](alps::hdf5::archive & clone_ar,
+                            std::string const& path)
+                        {
+                            std::cout << "Restoring samples from "
+                                      << clone_ar.get_filename()
+                                      << " (clone " << tid << ")"
+                                      << std::endl;
+                            return sim_type::restore_problem(parameters,
+                                clone_ar, path);
+                        });
+                });
+
             phase_point first_point;
-            for (int tid = 0; tid < n_clones; ++tid) {
-                sim_type sim(parameters, tid);
+            clone_problem_t clone_problem(0);
+            while (clone_problems.next(clone_problem)) {
+                if (clone_problem.size() == 0)
+                    continue;
+                if (prob.dim() == 0)
+                    first_point = clone_problem[0].second;
+                append_samples(std::move(clone_problem), n_samples);
+            }
+            return first_point;
+        };
 
-                std::string checkpoint_path = [&] {
-                    std::stringstream ss;
-                    ss << "simulation/clones/" << tid;
-                    return ss.str();
-                } ();
-
-                std::cout << "Restoring samples from " << cp.get_filename()
-                        << " (clone " << tid << ")"
-                        << std::endl;
-                cp[checkpoint_path] >> sim;
-
-                auto valid = [size = classifier->size()](label_t const& l) {
-                    return size_t(l) <= size;
-                };
-                if (prob.dim() == 0) {
-                    auto surrendered_problem = sim.surrender_problem();
-                    first_point = surrendered_problem[0].second;
-                    prob = problem_t(std::move(surrendered_problem),
-                        classifier->get_functor(),
-                        valid);
-                } else {
-                    prob.append_problem(sim.surrender_problem(),
-                        classifier->get_functor(),
-                        valid);
+        // Samples the phase points of the sweep and appends their samples to
+        // the problem right away, without going through a checkpoint file.
+        // The points are dealt out to the ranks in turn; the samples are then
+        // exchanged, such that all ranks hold the same problem, as the pair
+        // scheduler requires.
+        auto sample_points = [&] {
+            std::vector<phase_point> points;
+            auto sweep_pol = phase_space::sweep::from_parameters<phase_point>(parameters, "sweep.");
+            std::mt19937 rng{parameters["SEED"].as<std::mt19937::result_type>()};
+            std::generate_n(std::back_inserter(points), sweep_pol->size(),
+                [&, p=phase_point{}]() mutable {
+                    sweep_pol->yield(p, rng);
+                    return p;
+                });
+
+            size_t rank = comm_world.rank();
+            sim_type sim(parameters, rank);
+            sim.rebind_communicator(
+                mpi::split_communicator(comm_world, rank));
+            alps::stop_callback stop_cb(parameters["timelimit"].as<size_t>());
+            bool stopped = false;
+            size_t n_skipped = 0;
+            for (size_t k = rank; k < points.size(); k += comm_world.size()) {
+                if (stopped || (stopped = stop_cb())) {
+                    ++n_skipped;
+                    continue;
+                }
+                std::cout << '[' << rank << '/' << comm_world.size()
+                          << "]\tSampling " << points[k] << std::endl;
+                sim.reset_sweeps(!sim.update_phase_point(points[k]));
+                if (!sim.run(stop_cb)) {
+                    std::cerr << "Time limit reached while sampling "
+                              << points[k] << "; keeping "
+                              << 100. * sim.fraction_completed()
+                              << "% of its samples" << std::endl;
+                    stopped = true;
                 }
             }
-            return first_point;
+            if (n_skipped > 0) {
+                std::cerr << "Time limit reached: " << n_skipped
+                          << " phase point(s) of rank " << rank
+                          << " were not sampled" << std::endl;
+            }
+
+            // each rank writes its clone to a separate file, as *-sample does
+            if (cmdl["--save-clone"]) {
+                std::string checkpoint_file = parameters["checkpoint"];
+                std::string mode = parameters["compress"].as<bool>() ? "wc" : "w";
+                if (rank == 0)
+                    std::cout << "Saving samples to " << checkpoint_file
+                              << std::endl;
+                alps::hdf5::archive cp(
+                    clone_archive::file_name(checkpoint_file, rank), mode);
+                if (rank == 0)
+                    clone_archive::write_index(cp, checkpoint_file,
+                        comm_world.size());
+                cp[clone_archive::path(rank)] << sim;
+            }
+
+            append_samples(mpi::all_gather_problem(comm_world,
+                sim.surrender_problem()), 0);
+            return points.empty() ? phase_point{} : points.front();
         };
 
         phase_point first_point;
@@ -139,12 +234,15 @@ int main(int argc, char** argv)
             std::string checkpoint_file = alps::origin_name(parameters);
             alps::hdf5::archive cp(checkpoint_file, "r");
             first_point = process_archive(cp);
+        } else if (cmdl["--from-ini"]) {
+            first_point = sample_points();
         } else {
             std::cerr
             << "The *-learn program no longer samples configurations but only "
             << "classifies samples and performs the actual SVM optimization.\n"
             << "Launch the *-sample program with the INI parameter file, then "
-            << "provide the resulting .clone.h5 file as argument to *-learn.\n";
+            << "provide the resulting .clone.h5 file as argument to *-learn, "
+            << "or pass --from-ini to sample in the *-learn program itself.\n";
             return 1;
         }
 
@@ -160,7 +258,11 @@ int main(int argc, char** argv)
         );
 
         if (cmdl[{"-i", "--infinite-temperature"}]) {
+            // every rank reads the whole file of the phase point, such that
+            // all of them generate the same samples
             training_adapter<sim_base> sim(parameters, 0);
+            sim.rebind_communicator(mpi::split_communicator(comm_world,
+                comm_world.rank()));
             sim.update_phase_point(first_point);
 
             //size_t N_samples = parameters["sweep.samples"].as<size_t>();
@@ -195,26 +297,91 @@ int main(int argc, char** argv)
             // set cache_size of svm
             if(cmdl("--cache_size"))
                     cmdl("cache_size") >> kernel_params.cache_size();
+            // use dual coordinate descent instead of SMO
+            if (cmdl["--dual-cd"])
+                kernel_params.dual_coordinate_descent() = true;
+            // precompute Gram matrix shared by all pairs
+            std::string gram = cmdl("--gram", "none").str();
+            if (gram == "float")
+                kernel_params.gram(svm::gram_precision::FLOAT);
+            else if (gram == "double")
+                kernel_params.gram(svm::gram_precision::DOUBLE);
+            else if (gram != "none")
+                throw std::runtime_error("unknown Gram matrix precision: " + gram);
+            // every rank has read the samples itself; the pairs of labels are
+            // solved by whichever rank is free and the result is gathered
+            mpi::pair_scheduler scheduler(comm_world);
+            if (comm_world.size() > 1)
+                kernel_params.scheduler(scheduler.get());
+
+            // regularization parameters to solve for, in order; each
+            // optimization is warm-started from the previous one
+            std::vector<double> nu_path;
+            if (cmdl("--nu-path")) {
+                std::stringstream nu_ss{cmdl("--nu-path").str()};
+                for (std::string nu; std::getline(nu_ss, nu, ',');)
+                    nu_path.push_back(std::stod(nu));
+            } else {
+                nu_path.push_back(parameters["nu"].as<double>());
+            }
+
+            // previous result on a subset of the samples (e.g. before more
+            // clones were merged) to reuse the unchanged pairs of labels from
+            model_t previous;
+            if (cmdl("--warm-start")) {
+                std::string previous_file = cmdl("--warm-start").str();
+                std::cout << "Warm-starting from " << previous_file << std::endl;
+                alps::hdf5::archive ar(previous_file, "r");
+                svm::serialization::model_serializer<svm::hdf5_tag, model_t> serial(previous);
+                ar["/model"] >> serial;
+            }
+
+            model_t model;
+            for (size_t k = 0; k < nu_path.size(); ++k) {
+                kernel_params.nu() = nu_path[k];
+                std::cout << "Creating SVM model..."
+                          << " (nu = " << kernel_params.nu()
+                          << ", cache_size: " << kernel_params.cache_size()
+                          << ", solver: "
+                          << (kernel_params.dual_coordinate_descent() ? "DCD" : "SMO")
+                          << ", Gram matrix: " << gram
+                          << ", total samples = " << prob.size()
+                          << ", ranks = " << comm_world.size() << ')'
+                          << std::endl;
+                if (k == 0 && !previous.empty())
+                    model = model_t(std::move(prob), kernel_params, previous);
+                else if (k == 0)
+                    model = model_t(std::move(prob), kernel_params);
+                else
+                    model = model_t(std::move(model), kernel_params);
+                std::cout << "Kernel cache hit rate: "
+                          << 100. * model.cache_hit_rate() << '%' << std::endl;
+
+                // all ranks hold the full model; only one writes it
+                if (comm_world.rank() != 0)
+                    continue;
+
+                // set up serializer
+                svm::serialization::model_serializer<svm::hdf5_tag, model_t> serial(
+                    model, cmdl["--save-sv"]);
 
-            std::cout << "Creating SVM model..."
-                      << " (nu = " << parameters["nu"].as<double>()
-                      << ", cache_size: " << kernel_params.cache_size()
-                      << ", total samples = " << prob.size() << ')'
-                      << std::endl;
-            model_t model(std::move(prob), kernel_params);
-
-            // set up serializer
-            svm::serialization::model_serializer<svm::hdf5_tag, model_t> serial(model);
-
-            // Saving to the output file
-            std::string output_file = parameters["outputfile"];
-            alps::hdf5::archive ar(output_file, "w");
-            ar["/parameters"] << parameters;
-            ar["/model"] << serial;
-
-            // Save parameters of merged clones
-            for (size_t i = 0; i < all_merged_params.size(); ++i)
-                ar["/merged_parameters/" + std::to_string(i)] << all_merged_params[i];
+                // Saving to the output file, one per value of nu on the path
+                std::string output_file = parameters["outputfile"];
+                if (cmdl("--nu-path")) {
+                    std::stringstream ss;
+                    ss << ".nu" << nu_path[k] << ".out.h5";
+                    output_file = replace_extension(output_file, ss.str());
+                    parameters["nu"] = nu_path[k];
+                }
+                std::cout << "Saving to " << output_file << std::endl;
+                alps::hdf5::archive ar(output_file, "w");
+                ar["/parameters"] << parameters;
+                ar["/model"] << serial;
+
+                // Save parameters of merged clones
+                for (size_t i = 0; i < all_merged_params.size(); ++i)
+                    ar["/merged_parameters/" + std::to_string(i)] << all_merged_params[i];
+            }
         }
         return 0;
     } catch (const std::exception& exc) {
@@ -103,13 +103,18 @@ int main(int argc, char** argv)
         using batches_type = sim_type::batcher::batches_type;
         using proxy_t = mpi::dispatcher<batches_type>::archive_proxy_type;
 
+        sim_type::batcher batcher{parameters};
+        batches_type batches = batcher(all_phase_points);
+        std::vector<size_t> batch_order = batcher.order(batches);
         mpi::dispatcher<batches_type> dispatch(checkpoint_file,
             archive_mutex,
             resumed,
-            sim_type::batcher{parameters}(all_phase_points),
+            std::move(batches),
+            std::move(batch_order),
             stop_cb,
             [&](proxy_t ar) { log() << "restoring checkpoint\n"; ar >> sim; },
-            [&](proxy_t ar) { log() << "writing checkpoint\n"; ar << sim; });
+            [&](proxy_t ar) { log() << "writing checkpoint\n"; ar << sim; },
+            parameters["compress"].as<bool>());
 
         while (dispatch.request_batch()) {
             bool valid = dispatch.valid();
@@ -127,7 +132,10 @@ int main(int argc, char** argv)
                       << slice_point << std::endl;
                 sim.reset_sweeps(!sim.update_phase_point(slice_point));
             }
-            sim.run(stop_cb);
+            if (!sim.run(stop_cb)) {
+                log() << "stopped batch " << dispatch.batch_index() << " at "
+                      << 100. * sim.fraction_completed() << "%" << std::endl;
+            }
         }
 
         return 0;
@@ -24,6 +24,7 @@
 #include <map>
 #include <random>
 #include <regex>
+#include <sstream>
 #include <stdexcept>
 #include <string>
 #include <tuple>
@@ -36,6 +37,7 @@
 #include <alps/params.hpp>
 
 #include <Eigen/Eigenvalues>
+#include <Eigen/SparseCore>
 
 #include <svm/svm.hpp>
 #include <svm/serialization/hdf5.hpp>
@@ -44,19 +46,20 @@
 #include <tksvm/phase_space/classifier.hpp>
 #include <tksvm/phase_space/sweep.hpp>
 #include <tksvm/phase_space/point/common.hpp>
+#include <tksvm/phase_space/point/index.hpp>
+#include <tksvm/utilities/eigensolver.hpp>
 
 
 using namespace tksvm;
 
 using phase_point = typename sim_base::phase_point;
-using kernel_t = svm::kernel::polynomial<2>;
-    using label_t = typename phase_space::classifier::policy<phase_point>::label_type;
-using model_t = svm::model<kernel_t, label_t>;
+using label_t = typename phase_space::classifier::policy<phase_point>::label_type;
+using model_t = svm::model_summary<label_t>;
 
 int main(int argc, char** argv)
 {
     argh::parser cmdl({"r", "rhoc", "R", "radius", "m", "mask", "masked-value",
-        "t", "threshold", "w", "weight"});
+        "t", "threshold", "w", "weight", "k", "n-evals", "scan-rhoc"});
     cmdl.parse(argc, argv, argh::parser::SINGLE_DASH_IS_MULTIFLAG);
     alps::params parameters = [&] {
         if (cmdl[1].empty())
@@ -84,7 +87,7 @@ int main(int argc, char** argv)
     double radius;
     cmdl({"-R", "--radius"}, std::numeric_limits<double>::max()) >> radius;
 
-    log_msg("Reading model...");
+    log_msg("Reading model biases...");
     model_t model;
     {
         alps::hdf5::archive ar(arname, "r");
@@ -114,28 +117,49 @@ int main(int argc, char** argv)
               << "Median bias: " << median << '\n'
               << "Half interquartile spacing: " << hiqs << '\n';
 
-    auto weight = [&]() -> std::function<double(double)> {
-        double rhoc;
-        std::string weight_name = cmdl({"-w", "--weight"}, "box").str();
+    auto default_rhoc = [&](std::string const& weight_name) {
+        if (weight_name == "box")
+            return 1.;
+        else if (weight_name == "gaussian")
+            return rho_std;
+        else if (weight_name == "lorentzian")
+            return hiqs;
+        throw std::runtime_error("unknown weight function: " + weight_name);
+    };
+    auto weight_function = [](std::string const& weight_name, double rhoc)
+        -> std::function<double(double)>
+    {
         if (weight_name == "box") {
-            cmdl({"-r", "--rhoc"}, 1.) >> rhoc;
             return [rhoc](double rho) {
                 return std::abs(std::abs(rho) - 1.) > rhoc;
             };
         } else if (weight_name == "gaussian") {
-            cmdl({"-r", "--rhoc"}, rho_std) >> rhoc;
             return [rhoc](double rho) {
                 return 1. - exp(-0.5 * pow((std::abs(rho) - 1.) / rhoc, 2.));
             };
         } else if (weight_name == "lorentzian") {
-            cmdl({"-r", "--rhoc"}, hiqs) >> rhoc;
-            return [&, gamma_sq = rhoc * rhoc](double rho) {
+            return [gamma_sq = rhoc * rhoc](double rho) {
                 return 1. - gamma_sq / (pow(std::abs(rho) - 1., 2.) + gamma_sq);
             };
         } else {
             throw std::runtime_error("unknown weight function: " + weight_name);
         }
-    }();
+    };
+
+    // in scan mode, --weight may hold a comma-separated list
+    std::vector<std::string> weight_names;
+    {
+        std::stringstream ss{cmdl({"-w", "--weight"}, "box").str()};
+        std::string name;
+        while (std::getline(ss, name, ','))
+            weight_names.push_back(name);
+        for (auto const& name : weight_names)
+            default_rhoc(name);
+    }
+    std::string scan_rhoc;
+    bool scan = bool(cmdl("--scan-rhoc") >> scan_rhoc);
+    if (!scan && weight_names.size() != 1)
+        throw std::runtime_error("multiple weight functions require --scan-rhoc");
 
     log_msg("Collecting phase space points...");
     std::map<label_t, phase_point> phase_points;
@@ -146,7 +170,6 @@ int main(int argc, char** argv)
             auto sweep_pol = phase_space::sweep::from_parameters<phase_point>(
                 parameters, "sweep.");
             std::vector<phase_point> points;
-            phase_space::point::distance<phase_point> dist;
             auto process_sweep = [&](alps::params const& parameters) {
                 auto sweep_pol = phase_space::sweep::from_parameters<phase_point>(
                     parameters, "sweep.");
@@ -154,11 +177,7 @@ int main(int argc, char** argv)
                 phase_point p;
                 for (size_t i = 0; i < sweep_pol->size(); ++i) {
                     sweep_pol->yield(p, rng);
-                    double min_dist = std::numeric_limits<double>::max();
-                    for (auto const& pp : points)
-                        min_dist = std::min(min_dist, dist(p, pp));
-                    if (min_dist > 1e-5)
-                        points.push_back(p);
+                    points.push_back(p);
                 }
             };
             process_sweep(parameters);
@@ -172,7 +191,7 @@ int main(int argc, char** argv)
                 process_sweep(merged_params);
             }
 
-            return points;
+            return phase_space::point::unique_points(points);
         }();
 
         // read mask if specified
@@ -261,9 +280,16 @@ int main(int argc, char** argv)
                 + *it);
     }
 
-    log_msg("Constructing graph...");
-    using matrix_t = Eigen::MatrixXd;
-    matrix_t L = matrix_t::Zero(graph_dim, graph_dim);
+    log_msg("Collecting graph edges...");
+    // transitions between phase points other than infinity; those in the
+    // graph connect the vertices i and j
+    struct edge_type {
+        label_t first, second;
+        double rho, aux_weight;
+        bool in_graph;
+        size_t i, j;
+    };
+    std::vector<edge_type> edges;
     {
         // get auxiliary weights iterators
         using iter_t = typename std::vector<double>::const_iterator;
@@ -272,8 +298,6 @@ int main(int argc, char** argv)
             std::back_inserter(aux_iters),
             std::mem_fn(&std::vector<double>::cbegin));
 
-        std::ofstream os("rho.txt");
-        std::ofstream os2("edges.txt");
         phase_space::point::distance<phase_point> dist{};
         for (auto const& transition : model.classifiers()) {
             auto labels = transition.labels();
@@ -281,49 +305,163 @@ int main(int argc, char** argv)
                 || size_t(labels.second) == phase_points.size())
                 continue;
 
-            double w = weight(transition.rho());
+            edge_type e {labels.first, labels.second, transition.rho(), 1.,
+                         false, 0, 0};
 
             // combine weights from auxiliary graphs
             for (auto & it : aux_iters)
-                w *= *(it++);
-
-            os << std::abs(transition.rho()) << '\t' << w << '\n';
+                e.aux_weight *= *(it++);
 
-            if (index_map.find(labels.first) == index_map.end()
-                || index_map.find(labels.second) == index_map.end())
+            if (index_map.find(labels.first) != index_map.end()
+                && index_map.find(labels.second) != index_map.end()
+                && dist(phase_points[labels.first], phase_points[labels.second]) <= radius)
             {
-                continue;
+                e.in_graph = true;
+                e.i = index_map[labels.first];
+                e.j = index_map[labels.second];
             }
+            edges.push_back(e);
+        }
+    }
+
+    auto laplacian = [&](std::function<double(double)> const& weight) {
+        std::vector<Eigen::Triplet<double>> entries;
+        for (auto const& e : edges) {
+            double w = weight(e.rho) * e.aux_weight;
+            if (e.in_graph && w != 0) {
+                entries.emplace_back(e.i, e.j, -w);
+                entries.emplace_back(e.j, e.i, -w);
+                entries.emplace_back(e.i, e.i, w);
+                entries.emplace_back(e.j, e.j, w);
+            }
+        }
+        sparse_matrix_t L(graph_dim, graph_dim);
+        L.setFromTriplets(entries.begin(), entries.end());
+        return L;
+    };
 
-            if (dist(phase_points[labels.first], phase_points[labels.second]) > radius)
+    // writes one value per phase point, e.g. an eigenvector element
+    double masked_value;
+    bool use_masked_value = bool(cmdl("--masked-value") >> masked_value);
+    auto write_phase_points = [&](std::ostream & os, auto const& vec) {
+        label_t l;
+        phase_point p;
+        for (auto const& label_point_pair : phase_points) {
+            std::tie(l, p) = label_point_pair;
+            auto idx_it = index_map.find(l);
+            if (idx_it == index_map.end()) {
+                if (use_masked_value) {
+                    std::copy(p.begin(), p.end(),
+                        std::ostream_iterator<double>{os, "\t"});
+                    os << masked_value << '\n';
+                }
+            } else {
+                std::copy(p.begin(), p.end(),
+                    std::ostream_iterator<double>{os, "\t"});
+                os << vec(idx_it->second) << '\n';
+            }
+        }
+    };
+
+    size_t n_evals;
+    if (scan) {
+        std::vector<std::pair<std::string, double>> settings;
+        {
+            double rhoc_min, rhoc_max;
+            size_t steps;
+            char sep1, sep2;
+            std::stringstream ss{scan_rhoc};
+            if (!(ss >> rhoc_min >> sep1 >> rhoc_max >> sep2 >> steps)
+                || sep1 != ':' || sep2 != ':' || steps == 0)
+                throw std::runtime_error("invalid --scan-rhoc, expected "
+                                         "<min>:<max>:<steps>: " + scan_rhoc);
+            for (auto const& name : weight_names)
+                for (size_t s = 0; s < steps; ++s)
+                    settings.emplace_back(name, steps == 1 ? rhoc_min
+                        : rhoc_min + (rhoc_max - rhoc_min) * s / (steps - 1));
+        }
+        cmdl({"-k", "--n-evals"}, 8) >> n_evals;
+
+        log_msg("Computing Fiedler vectors of "
+                + std::to_string(settings.size()) + " graphs...");
+        std::vector<eigenpairs> results(settings.size());
+        std::vector<std::string> errors(settings.size());
+#pragma omp parallel for schedule(dynamic)
+        for (size_t s = 0; s < settings.size(); ++s) {
+            try {
+                results[s] = lowest_eigenpairs(laplacian(weight_function(
+                    settings[s].first, settings[s].second)), n_evals);
+            } catch (std::exception const& e) {
+                errors[s] = e.what();
+            }
+        }
+
+        log_msg("Writing scan...");
+        std::ofstream os("scan.txt");
+        for (size_t s = 0; s < settings.size(); ++s) {
+            os << "# weight = " << settings[s].first
+               << ", rhoc = " << settings[s].second;
+            if (!errors[s].empty()) {
+                os << ", error: " << errors[s] << "\n\n\n";
                 continue;
+            }
+            auto const& evals = results[s].values;
+            size_t degen = 0;
+            while (degen < size_t(evals.size()) && evals(degen) < 1e-10)
+                ++degen;
+            os << ", degeneracy = " << degen;
+            if (degen == size_t(evals.size())) {
+                os << ", Fiedler vector not among the computed eigenpairs\n\n\n";
+                continue;
+            }
+            os << ", eval = " << evals(degen) << '\n';
+            write_phase_points(os, [&](size_t i) {
+                    return results[s].vectors(i, degen);
+                });
+            os << "\n\n";
+        }
+        return 0;
+    }
 
-            size_t i = index_map[labels.first], j = index_map[labels.second];
-            if (w > 0) {
-                std::copy(phase_points[labels.first].begin(),
-                    phase_points[labels.first].end(),
+    log_msg("Constructing graph...");
+    using matrix_t = Eigen::MatrixXd;
+    double rhoc;
+    cmdl({"-r", "--rhoc"}, default_rhoc(weight_names.front())) >> rhoc;
+    auto weight = weight_function(weight_names.front(), rhoc);
+    sparse_matrix_t L = laplacian(weight);
+    {
+        std::ofstream os("rho.txt");
+        std::ofstream os2("edges.txt");
+        for (auto const& e : edges) {
+            double w = weight(e.rho) * e.aux_weight;
+            os << std::abs(e.rho) << '\t' << w << '\n';
+            if (e.in_graph && w > 0) {
+                std::copy(phase_points[e.first].begin(),
+                    phase_points[e.first].end(),
                     std::ostream_iterator<double> {os2, "\t"});
-                std::copy(phase_points[labels.second].begin(),
-                    phase_points[labels.second].end(),
+                std::copy(phase_points[e.second].begin(),
+                    phase_points[e.second].end(),
                     std::ostream_iterator<double> {os2, "\t"});
                 os2 << w << '\n';
             }
-
-            L(i,j) = -w;
-            L(j,i) = -w;
-            L(i,i) += w;
-            L(j,j) += w;
         }
     }
 
-    log_msg("Diagonalizing Laplacian...");
-    auto eigen = Eigen::SelfAdjointEigenSolver<matrix_t>(L);
-    auto const& evecs = eigen.eigenvectors();
+    eigenpairs eigen;
+    if (cmdl({"-k", "--n-evals"}) >> n_evals && n_evals < graph_dim) {
+        log_msg("Computing lowest eigenpairs of sparse Laplacian...");
+        eigen = lowest_eigenpairs(L, n_evals);
+    } else {
+        log_msg("Diagonalizing Laplacian...");
+        Eigen::SelfAdjointEigenSolver<matrix_t> solver{matrix_t(L)};
+        eigen = {solver.eigenvalues(), solver.eigenvectors()};
+    }
+    auto const& evecs = eigen.vectors;
 
     std::vector<std::pair<size_t, double>> evals;
-    evals.reserve(phase_points.size());
-    for (size_t i = 0; i < graph_dim; ++i)
-        evals.emplace_back(i, eigen.eigenvalues()(i));
+    evals.reserve(evecs.cols());
+    for (size_t i = 0; i < size_t(evecs.cols()); ++i)
+        evals.emplace_back(i, eigen.values(i));
     std::sort(evals.begin(), evals.end(),
               [](auto const& lhs, auto const& rhs) { return lhs.second < rhs.second; });
 
@@ -331,31 +469,13 @@ int main(int argc, char** argv)
     size_t degen = 0;
     {
         std::ofstream os("phases.txt");
-        double masked_value;
-        bool use_masked_value = bool(cmdl("--masked-value") >> masked_value);
-        for (size_t i = 0; i < graph_dim; ++i) {
+        for (size_t i = 0; i < evals.size(); ++i) {
             os << "# eval = " << evals[i].second << '\n';
             if (evals[i].second < 1e-10)
                 ++degen;
-            label_t l;
-            phase_point p;
-            for (auto const& label_point_pair : phase_points) {
-                std::tie(l, p) = label_point_pair;
-                auto idx_it = index_map.find(l);
-                if (idx_it == index_map.end()) {
-                    if (use_masked_value) {
-                        std::copy(p.begin(), p.end(),
-                            std::ostream_iterator<double>{os, "\t"});
-                        os << masked_value << '\n';
-                    } else {
-                        continue;
-                    }
-                } else {
-                    std::copy(p.begin(), p.end(),
-                        std::ostream_iterator<double>{os, "\t"});
-                    os << evecs(idx_it->second, evals[i].first) << '\n';
-                }
-            }
+            write_phase_points(os, [&](size_t j) {
+                    return evecs(j, evals[i].first);
+                });
             os << "\n\n";
         }
     }
@@ -364,6 +484,9 @@ int main(int argc, char** argv)
     double threshold;
     if (cmdl({"-t", "--threshold"}) >> threshold) {
         bool invert_mask = cmdl["--invert-mask"];
+        if (degen >= evals.size())
+            throw std::runtime_error("Fiedler vector not among the computed "
+                                     "eigenpairs; increase --n-evals");
         std::ofstream os("mask.txt");
         auto const& fiedler_vec = evecs.col(evals[degen].first);
         for (auto it = phase_points.begin(); it != phase_points.end(); ++it) {
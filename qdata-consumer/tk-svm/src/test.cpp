@@ -119,8 +119,7 @@ int main(int argc, char** argv)
             double rho;
         };
         auto classifiers = [&] {
-            using kernel_t = svm::kernel::polynomial<2>;
-            using model_t = svm::model<kernel_t, phase_label>;
+            using model_t = svm::model_summary<phase_label>;
 
             std::vector<skeleton_classifier> cl;
 
@@ -144,10 +143,14 @@ int main(int argc, char** argv)
         using batches_type = typename sim_type::batcher::batches_type;
         using proxy_t = mpi::dispatcher<batches_type>::archive_proxy_type;
 
+        sim_type::batcher batcher{parameters};
+        batches_type batches = batcher(all_phase_points);
+        std::vector<size_t> batch_order = batcher.order(batches);
         mpi::dispatcher<batches_type> dispatch(test_filename,
             archive_mutex,
             resumed,
-            sim_type::batcher{parameters}(all_phase_points),
+            std::move(batches),
+            std::move(batch_order),
             stop_cb,
             [&](proxy_t ar) { log() << "restoring checkpoint\n"; ar >> sim; },
             [&](proxy_t ar) { log() << "writing checkpoint\n"; ar << sim; });
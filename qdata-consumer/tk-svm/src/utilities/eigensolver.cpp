@@ -0,0 +1,103 @@
+// SVM Order Parameters for Hidden Spin Order
+// Copyright (C) 2018-2019  Jonas Greitemann, Ke Liu, and Lode Pollet
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+
+#include <Eigen/Eigenvalues>
+#include <Eigen/QR>
+#include <Eigen/SparseCholesky>
+
+#include <tksvm/utilities/eigensolver.hpp>
+
+
+tksvm::eigenpairs tksvm::lowest_eigenpairs(sparse_matrix_t const& A,
+                                           size_t n_evals, double tol)
+{
+    using matrix_t = Eigen::MatrixXd;
+    size_t n = A.rows();
+    size_t k = std::min(n_evals, n);
+    size_t b = std::min(k + 4, n);
+    size_t max_basis = std::min(n, std::max<size_t>(10 * b, 100));
+
+    if (max_basis < 2 * b || n <= 200) {
+        Eigen::SelfAdjointEigenSolver<matrix_t> eigen{matrix_t(A)};
+        return {eigen.eigenvalues().head(k), eigen.eigenvectors().leftCols(k)};
+    }
+
+    // Gershgorin bound on the spectral radius sets the scale of the shift
+    // and the residual tolerance
+    double norm = 0;
+    for (Eigen::Index j = 0; j < A.outerSize(); ++j) {
+        double col_sum = 0;
+        for (sparse_matrix_t::InnerIterator it(A, j); it; ++it)
+            col_sum += std::abs(it.value());
+        norm = std::max(norm, col_sum);
+    }
+    norm = std::max(norm, 1.);
+    sparse_matrix_t shifted = A;
+    {
+        sparse_matrix_t id(n, n);
+        id.setIdentity();
+        shifted += 1e-8 * norm * id;
+    }
+    Eigen::SimplicialLDLT<sparse_matrix_t> solver(shifted);
+    if (solver.info() != Eigen::Success)
+        throw std::runtime_error("factorization of shifted matrix failed");
+
+    std::mt19937 rng(42);
+    std::normal_distribution<double> normal;
+    matrix_t X(n, b);
+    for (Eigen::Index j = 0; j < X.cols(); ++j)
+        for (Eigen::Index i = 0; i < X.rows(); ++i)
+            X(i, j) = normal(rng);
+
+    matrix_t V(n, max_basis), AV(n, max_basis);
+    for (size_t restart = 0; restart < 100; ++restart) {
+        size_t m = 0;
+        matrix_t W = X;
+        while (m + b <= max_basis) {
+            // orthonormalize against the basis; twice is enough
+            for (int pass = 0; pass < 2; ++pass) {
+                if (m > 0)
+                    W -= V.leftCols(m) * (V.leftCols(m).transpose() * W);
+                Eigen::HouseholderQR<matrix_t> qr(W);
+                W = qr.householderQ() * matrix_t::Identity(n, b);
+            }
+            V.middleCols(m, b) = W;
+            AV.middleCols(m, b) = A * W;
+            m += b;
+
+            // Rayleigh-Ritz
+            matrix_t H = V.leftCols(m).transpose() * AV.leftCols(m);
+            Eigen::SelfAdjointEigenSolver<matrix_t> ritz(0.5 * (H + H.transpose()));
+            matrix_t Y = ritz.eigenvectors().leftCols(b);
+            X = V.leftCols(m) * Y;
+            matrix_t R = AV.leftCols(m) * Y.leftCols(k)
+                - X.leftCols(k) * ritz.eigenvalues().head(k).asDiagonal();
+            if (R.colwise().norm().maxCoeff() <= tol * norm)
+                return {ritz.eigenvalues().head(k), X.leftCols(k)};
+
+            W = solver.solve(W);
+        }
+        // restart from the b lowest Ritz vectors only; the rest of the
+        // basis is discarded, so this is not a thick restart (the coupling
+        // to the residual directions is not retained)
+    }
+    throw std::runtime_error("lowest_eigenpairs did not converge");
+}
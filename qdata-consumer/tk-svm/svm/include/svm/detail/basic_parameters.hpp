@@ -33,6 +33,12 @@ namespace svm {
         NU_SVR = NU_SVR
     };
 
+    enum class gram_precision {
+        NONE = GRAM_NONE,
+        FLOAT = GRAM_FLOAT,
+        DOUBLE = GRAM_DOUBLE
+    };
+
     namespace detail {
 
         class basic_parameters {
@@ -61,11 +67,29 @@ namespace svm {
                 params.weight = NULL;
                 params.shrinking = 1;
                 params.probability = 0;
+                params.dual_cd = 0;
+                params.gram = GRAM_NONE;
+                params.warm_start = NULL;
+                params.scheduler = NULL;
             }
 
+            double nu() const { return params.nu; }
+            double & nu() { return params.nu; }
+
             double cache_size() const { return params.cache_size; }
             double & cache_size() { return params.cache_size; }
 
+            gram_precision gram() const {
+                return static_cast<gram_precision>(params.gram);
+            }
+            void gram(gram_precision g) { params.gram = static_cast<int>(g); }
+
+            // distribute the pairs of a multiclassification among processes;
+            // the scheduler has to outlive the training
+            void scheduler(struct svm_pair_scheduler const* s) {
+                params.scheduler = s;
+            }
+
             struct svm_parameter * svm_params_ptr () {
                 return &params;
             }
@@ -54,6 +54,11 @@ namespace svm {
                 append_problem(std::move(other), label_map, filter);
             }
 
+            void reserve (size_t n) {
+                orig_data.reserve(n);
+                labels.reserve(n);
+            }
+
             void add_sample(Container && ds, Label label) {
                 orig_data.push_back(std::move(ds));
                 labels.push_back(label);
@@ -0,0 +1,111 @@
+/*   Support Vector Machine Library Wrappers
+ *   Copyright (C) 2018-2019  Jonas Greitemann
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program, see the file entitled "LICENCE" in the
+ *   repository's root directory, or see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+
+
+namespace svm {
+
+    namespace detail {
+
+        // C += A B^T on a tile of R rows of A and S rows of B over kb
+        // common indices, keeping the R x S partial sums in registers
+        template <size_t R, size_t S>
+        inline void gemm_nt_tile (size_t kb,
+                                  double const* A, size_t lda,
+                                  double const* B, size_t ldb,
+                                  double * C, size_t ldc)
+        {
+            double acc[R][S] = {};
+            for (size_t p = 0; p < kb; ++p) {
+                double a[R], b[S];
+                for (size_t r = 0; r < R; ++r)
+                    a[r] = A[r * lda + p];
+                for (size_t s = 0; s < S; ++s)
+                    b[s] = B[s * ldb + p];
+                for (size_t r = 0; r < R; ++r)
+                    for (size_t s = 0; s < S; ++s)
+                        acc[r][s] += a[r] * b[s];
+            }
+            for (size_t r = 0; r < R; ++r)
+                for (size_t s = 0; s < S; ++s)
+                    C[r * ldc + s] += acc[r][s];
+        }
+
+        // C += A B^T, where A is m x k, B is n x k and C is m x n, all in
+        // row-major order with leading dimensions lda, ldb and ldc; i.e. the
+        // matrix of dot products between the rows of A and B is added to C.
+        // Serial, but blocked such that the operands of the inner loops stay
+        // in cache.
+        inline void gemm_nt_add (size_t m, size_t n, size_t k,
+                                 double const* A, size_t lda,
+                                 double const* B, size_t ldb,
+                                 double * C, size_t ldc)
+        {
+            const size_t MB = 64, NB = 64, KB = 256;
+            for (size_t k0 = 0; k0 < k; k0 += KB) {
+                size_t kb = std::min(KB, k - k0);
+                for (size_t i0 = 0; i0 < m; i0 += MB) {
+                    size_t i1 = std::min(i0 + MB, m);
+                    for (size_t j0 = 0; j0 < n; j0 += NB) {
+                        size_t j1 = std::min(j0 + NB, n);
+                        size_t i = i0;
+                        for (; i + 4 <= i1; i += 4) {
+                            size_t j = j0;
+                            for (; j + 4 <= j1; j += 4)
+                                gemm_nt_tile<4, 4>(kb, A + i * lda + k0, lda,
+                                                   B + j * ldb + k0, ldb,
+                                                   C + i * ldc + j, ldc);
+                            for (; j < j1; ++j)
+                                gemm_nt_tile<4, 1>(kb, A + i * lda + k0, lda,
+                                                   B + j * ldb + k0, ldb,
+                                                   C + i * ldc + j, ldc);
+                        }
+                        for (; i < i1; ++i) {
+                            size_t j = j0;
+                            for (; j + 4 <= j1; j += 4)
+                                gemm_nt_tile<1, 4>(kb, A + i * lda + k0, lda,
+                                                   B + j * ldb + k0, ldb,
+                                                   C + i * ldc + j, ldc);
+                            for (; j < j1; ++j)
+                                gemm_nt_tile<1, 1>(kb, A + i * lda + k0, lda,
+                                                   B + j * ldb + k0, ldb,
+                                                   C + i * ldc + j, ldc);
+                        }
+                    }
+                }
+            }
+        }
+
+        // C = A B^T; see gemm_nt_add
+        inline void gemm_nt (size_t m, size_t n, size_t k,
+                             double const* A, size_t lda,
+                             double const* B, size_t ldb,
+                             double * C, size_t ldc)
+        {
+            for (size_t i = 0; i < m; ++i)
+                std::fill(C + i * ldc, C + i * ldc + n, 0.);
+            gemm_nt_add(m, n, k, A, lda, B, ldb, C, ldc);
+        }
+
+    }
+
+}
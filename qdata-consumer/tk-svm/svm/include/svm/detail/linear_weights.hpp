@@ -0,0 +1,142 @@
+/*   Support Vector Machine Library Wrappers
+ *   Copyright (C) 2018-2019  Jonas Greitemann
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program, see the file entitled "LICENCE" in the
+ *   repository's root directory, or see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+#include <svm/libsvm/svm.h>
+
+
+namespace svm {
+
+    namespace detail {
+
+        // Weight vectors w = sum_s coef_s x_s of the linear decision functions
+        // of the classifiers between the classes (i,j) of the model m, given
+        // by their indices in m->label, as the rows of the row-major
+        // pairs.size() x dim matrix W. For i > j, the weight vector of the
+        // classifier (j,i) is negated. Each SV is traversed once for every
+        // classifier it takes part in; the classifiers are distributed
+        // among threads.
+        inline void linear_weights (struct svm_model const* m, size_t dim,
+                                    std::vector<std::pair<size_t, size_t>> const& pairs,
+                                    double * W)
+        {
+            size_t nr_class = m->nr_class;
+            std::vector<size_t> nz_start(nr_class, 0);
+            for (size_t i = 1; i < nr_class; ++i)
+                nz_start[i] = nz_start[i-1] + m->nSV[i-1];
+
+            auto accumulate = [&] (double * w, double sign, double const* coef, size_t k) {
+                for (int q = 0; q < m->nSV[k]; ++q) {
+                    double c = sign * coef[nz_start[k] + q];
+                    for (svm_node const* node = m->SV[nz_start[k] + q];
+                         node->index != -1; ++node)
+                        if (node->index >= 1 && size_t(node->index) <= dim)
+                            w[node->index - 1] += c * node->value;
+                }
+            };
+
+            // classifier (i,j): coefficients with
+            // i are in sv_coef[j-1][nz_start[i]...],
+            // j are in sv_coef[i][nz_start[j]...]
+#pragma omp parallel for schedule(dynamic)
+            for (size_t p = 0; p < pairs.size(); ++p) {
+                size_t i = std::min(pairs[p].first, pairs[p].second);
+                size_t j = std::max(pairs[p].first, pairs[p].second);
+                double sign = pairs[p].first < pairs[p].second ? 1 : -1;
+                double * w = W + p * dim;
+                std::fill(w, w + dim, 0.);
+                accumulate(w, sign, m->sv_coef[j-1], i);
+                accumulate(w, sign, m->sv_coef[i], j);
+            }
+        }
+
+        // weight vectors of all classifiers in the order of libsvm, i.e. of
+        // m->rho
+        inline void linear_weights (struct svm_model const* m, size_t dim,
+                                    double * W)
+        {
+            std::vector<std::pair<size_t, size_t>> pairs;
+            for (size_t i = 0; i < size_t(m->nr_class); ++i)
+                for (size_t j = i + 1; j < size_t(m->nr_class); ++j)
+                    pairs.emplace_back(i, j);
+            linear_weights(m, dim, pairs, W);
+        }
+
+        // Sets up the SVs of the linear model m such that they reproduce the
+        // decision functions with weight vectors W (as in linear_weights),
+        // using one pseudo-SV per classifier, namely its weight vector. The
+        // pseudo-SV of classifier (i,j) is assigned to class i with a
+        // coefficient of one in (i,j) and zero in all other classifiers of
+        // class i. Thus, the pseudo-SVs are in the order of the classifiers.
+        // Requires nr_class, label and rho to be set; allocates SV, sv_coef
+        // and nSV as svm_load_model does (free_sv = 1). A model of fewer
+        // than two classes has no classifiers and thus no SVs.
+        inline void linear_model_from_weights (struct svm_model * m, size_t dim,
+                                               double const* W)
+        {
+            size_t nr_class = m->nr_class;
+            size_t nrc = nr_class * (nr_class - 1) / 2;
+
+            m->l = nrc;
+            m->sv_indices = NULL;
+            m->nSV = (int *)malloc(sizeof(int) * nr_class);
+            for (size_t i = 0; i < nr_class; ++i)
+                m->nSV[i] = nr_class - 1 - i;
+            m->free_sv = 1;
+            if (nr_class < 2) {
+                m->sv_coef = NULL;
+                m->SV = NULL;
+                return;
+            }
+
+            m->sv_coef = (double **)malloc(sizeof(double *) * (nr_class-1));
+            for (size_t r = 0; r < nr_class - 1; ++r) {
+                m->sv_coef[r] = (double *)malloc(sizeof(double) * nrc);
+                for (size_t p = 0; p < nrc; ++p)
+                    m->sv_coef[r][p] = 0;
+            }
+            for (size_t i = 0, p = 0; i < nr_class; ++i)
+                for (size_t j = i + 1; j < nr_class; ++j, ++p)
+                    m->sv_coef[j-1][p] = 1;
+
+            // sparse representation, all in one block
+            size_t nnz = 0;
+            for (size_t k = 0; k < nrc * dim; ++k)
+                if (W[k] != 0)
+                    ++nnz;
+            m->SV = (struct svm_node **)malloc(sizeof(struct svm_node *) * nrc);
+            struct svm_node * node = (struct svm_node *)malloc(
+                sizeof(struct svm_node) * (nnz + nrc));
+            for (size_t p = 0; p < nrc; ++p) {
+                m->SV[p] = node;
+                for (size_t d = 0; d < dim; ++d)
+                    if (W[p * dim + d] != 0)
+                        *node++ = { int(d + 1), W[p * dim + d] };
+                *node++ = { -1, 0. };
+            }
+        }
+
+    }
+
+}
@@ -21,12 +21,14 @@
 #include <algorithm>
 #include <stdexcept>
 #include <utility>
+#include <vector>
 
 #include <svm/model.hpp>
 #include <svm/problem.hpp>
 #include <svm/parameters.hpp>
 
 #include <svm/detail/basic_parameters.hpp>
+#include <svm/detail/linear_weights.hpp>
 #include <svm/detail/patch_through_problem.hpp>
 
 #include <svm/libsvm/svm.h>
@@ -58,6 +60,9 @@ namespace svm {
         parameters (Args... args) : detail::basic_parameters(args...) {
             params.kernel_type = LINEAR;
         }
+
+        bool dual_coordinate_descent() const { return params.dual_cd; }
+        int & dual_coordinate_descent() { return params.dual_cd; }
     };
 
     template <class Classifier>
@@ -90,4 +95,32 @@ namespace svm {
         return linear_introspector<Classifier> {cl};
     }
 
+    // Coefficients of several classifiers of the model at once, as the rows
+    // of a row-major classifiers.size() x model.dim() matrix. Equivalent to
+    // linear_introspector::coefficient(i) for all i, but the SVs are traversed
+    // only once per classifier rather than once per coefficient.
+    template <class Model>
+    std::vector<double> linear_coefficients (Model const& model,
+        std::vector<typename Model::classifier_type> const& classifiers)
+    {
+        struct svm_model const* m = model.svm_model_ptr();
+        auto raw_index = [&] (typename Model::label_type const& l) {
+            size_t r = 0;
+            while (r < size_t(m->nr_class)
+                   && !(typename Model::label_type(m->label[r]) == l))
+                ++r;
+            if (r == size_t(m->nr_class))
+                throw std::runtime_error("label not found in model");
+            return r;
+        };
+        std::vector<std::pair<size_t, size_t>> pairs;
+        for (auto const& cl : classifiers) {
+            auto ls = cl.labels();
+            pairs.emplace_back(raw_index(ls.first), raw_index(ls.second));
+        }
+        std::vector<double> W(classifiers.size() * model.dim());
+        detail::linear_weights(m, model.dim(), pairs, W.data());
+        return W;
+    }
+
 }
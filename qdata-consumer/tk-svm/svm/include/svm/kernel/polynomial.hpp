@@ -24,6 +24,7 @@
 #include <stdexcept>
 #include <tuple>
 #include <utility>
+#include <vector>
 
 #include <combinatorics/combinatorics.hpp>
 
@@ -32,6 +33,7 @@
 #include <svm/parameters.hpp>
 
 #include <svm/detail/basic_parameters.hpp>
+#include <svm/detail/blas.hpp>
 #include <svm/detail/patch_through_problem.hpp>
 
 #include <svm/libsvm/svm.h>
@@ -108,6 +110,99 @@ namespace svm {
             return fac * sum;
         }
 
+        // All dim^K components of the (symmetric) coefficient tensor in
+        // row-major order, in a single pass over the support vectors. These
+        // are densified in chunks and contracted as a weighted SYRK,
+        // C = P diag(y alpha) X^T, where X holds the components of the SVs
+        // and P their products over ascending (K-1)-tuples of indices (P = X
+        // for K = 2). Only the entries with ascending indices are computed,
+        // in row blocks distributed among threads; the others follow by
+        // symmetry.
+        template <size_t L=K, typename = typename std::enable_if<L != 0>::type>
+        std::vector<double> full_tensor (size_t dim) const {
+            using tuple_t = std::array<size_t, K-1>;
+            const size_t NS = 256, RB = 64;
+            if (dim == 0)
+                return {};
+
+            std::vector<tuple_t> tuples;
+            std::vector<size_t> rank(combinatorics::ipow(dim, K-1));
+            auto dense_index = [dim] (size_t const* ind, size_t n) {
+                size_t r = 0;
+                for (size_t q = 0; q < n; ++q)
+                    r = r * dim + ind[q];
+                return r;
+            };
+            for (tuple_t t {};;) {
+                rank[dense_index(t.data(), K-1)] = tuples.size();
+                tuples.push_back(t);
+                size_t p = K-1;
+                while (p > 0 && t[p-1] == dim - 1)
+                    --p;
+                if (p == 0)
+                    break;
+                ++t[p-1];
+                std::fill(t.begin() + p, t.end(), t[p-1]);
+            }
+            size_t nt = tuples.size();
+            size_t nr_blocks = (nt + RB - 1) / RB;
+            std::vector<size_t> col0(nr_blocks, dim);
+            for (size_t r = 0; r < nt; ++r)
+                col0[r / RB] = std::min(col0[r / RB], K > 1 ? tuples[r][K-2] : 0);
+
+            std::vector<double> G(nt * dim, 0.);
+            std::vector<double> X(dim * NS), P(nt * NS), w(NS);
+            auto contract = [&] (size_t ns) {
+#pragma omp parallel for schedule(dynamic) if(nr_blocks > 1)
+                for (size_t b = 0; b < nr_blocks; ++b) {
+                    size_t r0 = b * RB, r1 = std::min(r0 + RB, nt), c0 = col0[b];
+                    for (size_t r = r0; r < r1; ++r) {
+                        double * Pr = &P[r * NS];
+                        std::copy(w.begin(), w.begin() + ns, Pr);
+                        for (size_t i : tuples[r])
+                            for (size_t s = 0; s < ns; ++s)
+                                Pr[s] *= X[i * NS + s];
+                    }
+                    detail::gemm_nt_add(r1 - r0, dim - c0, ns,
+                                        &P[r0 * NS], NS, &X[c0 * NS], NS,
+                                        &G[r0 * dim + c0], dim);
+                }
+            };
+
+            double yalpha;
+            data_view x;
+            size_t ns = 0;
+            for (auto p : classifier) {
+                std::tie(yalpha, x) = std::move(p);
+                auto itX = x.begin();
+                for (size_t i = 0; i < dim; ++i) {
+                    if (itX != x.end()) {
+                        X[i * NS + ns] = *itX;
+                        ++itX;
+                    } else {
+                        X[i * NS + ns] = 0.;
+                    }
+                }
+                w[ns] = yalpha;
+                if (++ns == NS) {
+                    contract(ns);
+                    ns = 0;
+                }
+            }
+            if (ns > 0)
+                contract(ns);
+
+            std::vector<double> T(combinatorics::ipow(dim, K));
+            for (size_t idx = 0; idx < T.size(); ++idx) {
+                std::array<size_t, K> ind;
+                for (size_t q = K, rest = idx; q > 0; --q, rest /= dim)
+                    ind[q-1] = rest % dim;
+                std::sort(ind.begin(), ind.end());
+                T[idx] = fac * G[rank[dense_index(ind.data(), K-1)] * dim + ind[K-1]];
+            }
+            return T;
+        }
+
         template <size_t L=K, typename = typename std::enable_if<L == 0>::type>
         double tensor () const {
             return fac - classifier.rho();
@@ -55,6 +55,21 @@ struct svm_problem
 
 enum { C_SVC, NU_SVC, ONE_CLASS, EPSILON_SVR, NU_SVR };	/* svm_type */
 enum { LINEAR, POLY, RBF, SIGMOID, PRECOMPUTED }; /* kernel_type */
+enum { GRAM_NONE, GRAM_FLOAT, GRAM_DOUBLE }; /* gram */
+
+struct svm_model;
+
+/* distributes the binary problems of one-vs-one training among processes */
+struct svm_pair_scheduler
+{
+	void *context;
+	/* ticket of the next pair to solve, drawn from a counter shared by all
+	   processes; pairs are handed out in order of decreasing size */
+	int (*next)(void *context);
+	/* concatenates the n doubles of each process into a buffer allocated by
+	   malloc, the length of which is stored in *total */
+	double *(*gather)(void *context, const double *local, long int n, long int *total);
+};
 
 struct svm_parameter
 {
@@ -65,7 +80,7 @@ struct svm_parameter
 	double coef0;	/* for poly/sigmoid */
 
 	/* these are for training only */
-	double cache_size; /* in MB */
+	double cache_size; /* in MB; for classification the total, shared by all pairs */
 	double eps;	/* stopping criteria */
 	double C;	/* for C_SVC, EPSILON_SVR and NU_SVR */
 	int nr_weight;		/* for C_SVC */
@@ -75,6 +90,10 @@ struct svm_parameter
 	double p;	/* for EPSILON_SVR */
 	int shrinking;	/* use the shrinking heuristics */
 	int probability; /* do probability estimates */
+	int dual_cd;	/* for linear NU_SVC: use dual coordinate descent solver */
+	int gram;	/* for C_SVC and NU_SVC: precompute Gram matrix shared by all pairs */
+	const struct svm_model *warm_start;	/* for NU_SVC: model trained on (a prefix of) the same data to start from; cold start if it has no sv_indices */
+	const struct svm_pair_scheduler *scheduler;	/* for C_SVC and NU_SVC: solve only some of the pairs in this process; not used by svm_cross_validation */
 };
 
 //
@@ -91,6 +110,8 @@ struct svm_model
 	double *probA;		/* pariwise probability information */
 	double *probB;
 	int *sv_indices;        /* sv_indices[0,...,nSV-1] are values in [1,...,num_traning_data] to indicate SVs in the training set */
+	int l_train;		/* size of the training set; 0 if unknown */
+	unsigned int checksum_train;	/* checksum of the labels and samples of the training set */
 
 	/* for classification only */
 
@@ -100,6 +121,9 @@ struct svm_model
 	/* XXX */
 	int free_sv;		/* 1 if svm_model is created by svm_load_model*/
 				/* 0 if svm_model is created by svm_train */
+
+	long int cache_hits;	/* kernel cache statistics of svm_train */
+	long int cache_misses;	/* (classification only) */
 };
 
 struct svm_model *svm_train(const struct svm_problem *prob, const struct svm_parameter *param);
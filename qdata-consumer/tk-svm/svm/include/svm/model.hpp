@@ -25,10 +25,16 @@
 #include <stdexcept>
 #include <type_traits>
 #include <utility>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #include <svm/dataset.hpp>
 #include <svm/problem.hpp>
 #include <svm/parameters.hpp>
+#include <svm/detail/blas.hpp>
 #include <svm/detail/container_factory.hpp>
 #include <svm/libsvm/svm.h>
 #include <svm/serialization/serializer.hpp>
@@ -251,6 +257,11 @@ namespace svm {
             return nr_labels() * (nr_labels() - 1) / 2;
         }
 
+        double cache_hit_rate() const {
+            long int total = m->cache_hits + m->cache_misses;
+            return total > 0 ? 1. * m->cache_hits / total : 0.;
+        }
+
         using decision_type =
             std::conditional_t<traits::is_binary_label<Label>::value,
                                double,
@@ -274,24 +285,24 @@ namespace svm {
             : prob(std::move(problem)),
               params_(parameters)
         {
-            struct svm_problem svm_prob = prob.generate();
-            const char * err = svm_check_parameter(&svm_prob, params_.svm_params_ptr());
-            if (err) {
-                std::string err_str(err);
-                throw std::runtime_error(err_str);
-            }
-            m = svm_train(&svm_prob, params_.svm_params_ptr());
-            if (!traits::is_dynamic_label<Label>::value
-                && size_t(m->nr_class) != traits::label_traits<Label>::nr_labels)
-            {
-                throw std::runtime_error("inconsistent number of label values");
-            }
-            if (std::any_of(m->rho, m->rho + nr_classifiers(),
-                            [] (double r) { return std::isnan(r); }))
-                throw std::runtime_error("SVM returned NaN. Specified nu is infeasible.");
-            init_perm();
+            train(nullptr);
         }
 
+        // warm-start from the solution of a model which has been trained on
+        // the same samples or a prefix thereof (nu-SVC only)
+        model (problem_t && problem, parameters_t const& parameters,
+               model const& warm_start)
+            : prob(std::move(problem)),
+              params_(parameters)
+        {
+            train(warm_start.m);
+        }
+
+        // retrain on the problem of a previous model using new parameters,
+        // warm-starting from the previous solution (nu-SVC only)
+        model (model && previous, parameters_t const& parameters)
+            : model(std::move(previous.prob), parameters, previous) {}
+
         model (model const&) = delete;
         model & operator= (model const&) = delete;
 
@@ -400,6 +411,134 @@ namespace svm {
             return p;
         }
 
+        // Evaluates n samples at once, given as the rows of the dense n x dim()
+        // matrix X (row-major). The kernel values of a block of samples with
+        // all SVs are obtained from one matrix product (or from the sparse SVs
+        // if a dense copy of them would take more memory than the SVs
+        // themselves) and the blocks are distributed among threads. The
+        // predicted labels are written to labels[0...n-1] and the decision
+        // values, ordered as by operator(), to the rows of the
+        // n x nr_classifiers() matrix decisions; either may be nullptr. The
+        // workspace is sized by the batch and only allocated when a call
+        // needs more of it than the previous ones. Not to be called
+        // concurrently on the same model.
+        template <typename Problem = problem_t,
+                  typename = std::enable_if_t<!Problem::is_precomputed>>
+        void predict_batch (double const* X, size_t n,
+                            Label * labels, double * decisions) const
+        {
+            init_batch();
+            size_t l = m->l;
+            size_t dim = prob.dim();
+            size_t nr_class = m->nr_class;
+            size_t nrc = nr_classifiers();
+            const size_t B = batch_cache::block;
+            size_t nr_blocks = (n + B - 1) / B;
+            const svm_parameter& param = m->param;
+            if (n == 0)
+                return;
+
+            size_t rows = std::min(B, n);
+            int nr_threads = std::min<size_t>(batch_.nr_threads, nr_blocks);
+            size_t stride = rows * l + nrc;
+            if (batch_.work.size() < nr_threads * stride)
+                batch_.work.resize(nr_threads * stride);
+            if (batch_.votes.size() < nr_threads * nr_class)
+                batch_.votes.resize(nr_threads * nr_class);
+
+#pragma omp parallel for schedule(dynamic) num_threads(nr_threads) if(nr_blocks > 1)
+            for (size_t blk = 0; blk < nr_blocks; ++blk) {
+#ifdef _OPENMP
+                size_t tid = omp_get_thread_num();
+#else
+                size_t tid = 0;
+#endif
+                double * kvalue = &batch_.work[tid * stride];
+                double * dec = kvalue + rows * l;
+                int * vote = &batch_.votes[tid * nr_class];
+                size_t b0 = blk * B;
+                size_t nb = std::min(B, n - b0);
+                double const* Xb = X + b0 * dim;
+
+                if (batch_.dense) {
+                    detail::gemm_nt(nb, l, dim, Xb, dim, batch_.sv.data(), dim, kvalue, l);
+                } else {
+                    for (size_t b = 0; b < nb; ++b)
+                        for (size_t i = 0; i < l; ++i) {
+                            double sum = 0;
+                            for (svm_node const* node = m->SV[i]; node->index != -1; ++node)
+                                if (node->index >= 1 && size_t(node->index) <= dim)
+                                    sum += Xb[b * dim + node->index - 1] * node->value;
+                            kvalue[b * l + i] = sum;
+                        }
+                }
+                for (size_t b = 0; b < nb; ++b) {
+                    double * kv = kvalue + b * l;
+                    switch (param.kernel_type) {
+                    case POLY:
+                        for (size_t i = 0; i < l; ++i) {
+                            double base = param.gamma * kv[i] + param.coef0, ret = 1.;
+                            for (int t = param.degree; t > 0; t /= 2) {
+                                if (t % 2 == 1)
+                                    ret *= base;
+                                base *= base;
+                            }
+                            kv[i] = ret;
+                        }
+                        break;
+                    case RBF: {
+                        double x_sq = 0;
+                        for (size_t d = 0; d < dim; ++d)
+                            x_sq += Xb[b * dim + d] * Xb[b * dim + d];
+                        for (size_t i = 0; i < l; ++i)
+                            kv[i] = std::exp(-param.gamma * std::max(
+                                x_sq + batch_.sv_sq[i] - 2 * kv[i], 0.));
+                        break;
+                    }
+                    case SIGMOID:
+                        for (size_t i = 0; i < l; ++i)
+                            kv[i] = std::tanh(param.gamma * kv[i] + param.coef0);
+                        break;
+                    default:
+                        break;
+                    }
+
+                    // classifier (i,j): coefficients with
+                    // i are in sv_coef[j-1][nz_start[i]...],
+                    // j are in sv_coef[i][nz_start[j]...]
+                    std::fill(vote, vote + nr_class, 0);
+                    for (size_t i = 0, p = 0; i < nr_class; ++i) {
+                        for (size_t j = i + 1; j < nr_class; ++j, ++p) {
+                            size_t si = batch_.nz_start[i];
+                            size_t sj = batch_.nz_start[j];
+                            double const* coef1 = m->sv_coef[j-1];
+                            double const* coef2 = m->sv_coef[i];
+                            double sum = 0;
+                            for (int k = 0; k < m->nSV[i]; ++k)
+                                sum += coef1[si+k] * kv[si+k];
+                            for (int k = 0; k < m->nSV[j]; ++k)
+                                sum += coef2[sj+k] * kv[sj+k];
+                            dec[p] = sum - m->rho[p];
+                            ++vote[dec[p] > 0 ? i : j];
+                        }
+                    }
+
+                    if (labels) {
+                        size_t vote_max_idx = 0;
+                        for (size_t i = 1; i < nr_class; ++i)
+                            if (vote[i] > vote[vote_max_idx])
+                                vote_max_idx = i;
+                        labels[b0 + b] = Label{double(m->label[vote_max_idx])};
+                    }
+                    if (decisions) {
+                        double * out = decisions + (b0 + b) * nrc;
+                        for (size_t c = 0; c < nrc; ++c)
+                            out[c] = batch_.dec_sign[c] * dec[batch_.dec_index[c]];
+                    }
+                }
+            }
+        }
+
         decision_type rho() const {
             auto r = detail::container_factory<decision_type>::copy(
                 m->rho, m->rho + nr_classifiers());
@@ -420,6 +559,11 @@ namespace svm {
             return params_;
         }
 
+        // the underlying libsvm model, e.g. for kernel-specific introspection
+        struct svm_model const* svm_model_ptr () const {
+            return m;
+        }
+
         bool empty() const {
             return m == nullptr;
         }
@@ -428,7 +572,31 @@ namespace svm {
         friend struct serialization::model_serializer;
 
     private:
+        void train (struct svm_model const* warm_start) {
+            struct svm_problem svm_prob = prob.generate();
+            params_.svm_params_ptr()->warm_start = warm_start;
+            const char * err = svm_check_parameter(&svm_prob, params_.svm_params_ptr());
+            if (!err)
+                m = svm_train(&svm_prob, params_.svm_params_ptr());
+            params_.svm_params_ptr()->warm_start = nullptr;
+            if (err) {
+                std::string err_str(err);
+                throw std::runtime_error(err_str);
+            }
+            if (!traits::is_dynamic_label<Label>::value
+                && size_t(m->nr_class) != traits::label_traits<Label>::nr_labels)
+            {
+                throw std::runtime_error("inconsistent number of label values");
+            }
+            if (std::any_of(m->rho, m->rho + nr_classifiers(),
+                            [] (double r) { return std::isnan(r); }))
+                throw std::runtime_error("SVM returned NaN. Specified nu is infeasible.");
+            init_perm();
+        }
+
         void init_perm () {
+            batch_ = batch_cache {};
+
             // prep member vars
             perm_inv = detail::container_factory<perm_t>::create(nr_labels());
             permc = detail::container_factory<permc_t>::create(nr_classifiers());
@@ -492,6 +660,69 @@ namespace svm {
             a *= permc_signs[0];
         }
 
+        // dense copy of the SVs (unless sparse) and workspace for predict_batch
+        struct batch_cache {
+            static const size_t block = 64;
+            bool dense = true;
+            std::vector<double> sv;
+            std::vector<double> sv_sq;
+            std::vector<size_t> nz_start;
+            std::vector<size_t> dec_index;
+            std::vector<int> dec_sign;
+            std::vector<double> work;
+            std::vector<int> votes;
+            int nr_threads = 0;
+        };
+
+        void init_batch () const {
+            if (batch_.nr_threads > 0)
+                return;
+            size_t l = m->l;
+            size_t dim = prob.dim();
+            size_t nr_class = m->nr_class;
+            size_t nrc = nr_classifiers();
+
+            // the dense copy takes 8 bytes per entry, the SVs 16 bytes per
+            // nonzero; it is only made if it is no larger than the SVs
+            size_t nnz = 0;
+            batch_.sv_sq.assign(l, 0.);
+            for (size_t i = 0; i < l; ++i) {
+                for (svm_node const* node = m->SV[i]; node->index != -1; ++node) {
+                    batch_.sv_sq[i] += node->value * node->value;
+                    ++nnz;
+                }
+            }
+            batch_.dense = l * dim <= 2 * nnz;
+            if (batch_.dense) {
+                batch_.sv.assign(l * dim, 0.);
+                for (size_t i = 0; i < l; ++i)
+                    for (svm_node const* node = m->SV[i]; node->index != -1; ++node)
+                        if (node->index >= 1 && size_t(node->index) <= dim)
+                            batch_.sv[i * dim + node->index - 1] = node->value;
+            }
+            batch_.nz_start.assign(nr_class, 0);
+            for (size_t i = 1; i < nr_class; ++i)
+                batch_.nz_start[i] = batch_.nz_start[i-1] + m->nSV[i-1];
+
+            // output position c of permute() holds classifier dec_index[c],
+            // multiplied by dec_sign[c]
+            std::vector<double> trace(nrc);
+            std::iota(trace.begin(), trace.end(), 1.);
+            permute(trace);
+            batch_.dec_index.resize(nrc);
+            batch_.dec_sign.resize(nrc);
+            for (size_t c = 0; c < nrc; ++c) {
+                batch_.dec_index[c] = std::abs(trace[c]) - 1;
+                batch_.dec_sign[c] = trace[c] > 0 ? 1 : -1;
+            }
+
+#ifdef _OPENMP
+            batch_.nr_threads = omp_get_max_threads();
+#else
+            batch_.nr_threads = 1;
+#endif
+        }
+
         template <size_t... R>
         classifier_arr_t classifiers_impl (std::index_sequence<R...>) const {
             auto get_cl = [&](size_t r) -> classifier_type {
@@ -521,6 +752,7 @@ namespace svm {
         perm_t perm_inv;
         mutable permc_t permc;
         permc_signs_t permc_signs;
+        mutable batch_cache batch_;
     };
 
 }
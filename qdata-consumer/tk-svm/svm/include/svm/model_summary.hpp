@@ -0,0 +1,139 @@
+/*   Support Vector Machine Library Wrappers
+ *   Copyright (C) 2018-2019  Jonas Greitemann
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program, see the file entitled "LICENCE" in the
+ *   repository's root directory, or see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include <svm/libsvm/svm.h>
+#include <svm/serialization/serializer.hpp>
+
+
+namespace svm {
+
+    // The biases, labels and numbers of SVs of a multiclassification model,
+    // without its SVs. Labels and classifiers are ordered and oriented as by
+    // model<Kernel, Label>. Obtained from a model or loaded by itself, reading
+    // only the respective datasets of a serialized model.
+    template <class Label = double>
+    class model_summary {
+    public:
+        using label_type = Label;
+
+        struct classifier_type {
+            std::pair<Label, Label> labels () const {
+                return labels_;
+            }
+
+            double rho () const {
+                return rho_;
+            }
+
+        private:
+            friend class model_summary;
+            classifier_type (std::pair<Label, Label> labels, double rho)
+                : labels_(std::move(labels)), rho_(rho) {}
+
+            std::pair<Label, Label> labels_;
+            double rho_;
+        };
+
+        model_summary () = default;
+
+        template <class Model>
+        explicit model_summary (Model const& model) {
+            struct svm_model const* m = model.svm_model_ptr();
+            size_t nr_class = m->nr_class;
+            label.assign(m->label, m->label + nr_class);
+            rho.assign(m->rho, m->rho + nr_class * (nr_class - 1) / 2);
+            if (m->nSV)
+                nSV_.assign(m->nSV, m->nSV + nr_class);
+            init_perm();
+        }
+
+        size_t nr_labels () const {
+            return label.size();
+        }
+
+        size_t nr_classifiers () const {
+            return rho.size();
+        }
+
+        std::vector<Label> labels () const {
+            std::vector<Label> ret;
+            ret.reserve(nr_labels());
+            for (size_t k : perm_inv)
+                ret.push_back(Label(label[k]));
+            return ret;
+        }
+
+        // number of SVs per label, in the order of labels(); empty if unknown
+        std::vector<size_t> nSV () const {
+            std::vector<size_t> ret;
+            if (nSV_.empty())
+                return ret;
+            for (size_t k : perm_inv)
+                ret.push_back(nSV_[k]);
+            return ret;
+        }
+
+        std::vector<classifier_type> classifiers () const {
+            std::vector<classifier_type> cls;
+            cls.reserve(nr_classifiers());
+            for (size_t r1 = 0; r1 + 1 < nr_labels(); ++r1)
+                for (size_t r2 = r1 + 1; r2 < nr_labels(); ++r2)
+                    cls.push_back(classifier(perm_inv[r1], perm_inv[r2]));
+            return cls;
+        }
+
+        template <typename Tag, typename Model>
+        friend struct serialization::model_serializer;
+
+    private:
+        classifier_type classifier (size_t k1, size_t k2) const {
+            double sign = 1;
+            if (k1 > k2) {
+                std::swap(k1, k2);
+                sign = -1;
+            }
+            size_t k_comb = k1 * (nr_labels() - 1) - k1 * (k1 - 1) / 2 + k2 - k1 - 1;
+            std::pair<Label, Label> ls {Label(label[k1]), Label(label[k2])};
+            if (sign < 0)
+                std::swap(ls.first, ls.second);
+            return {std::move(ls), sign * rho[k_comb]};
+        }
+
+        void init_perm () {
+            perm_inv.resize(nr_labels());
+            std::iota(perm_inv.begin(), perm_inv.end(), 0);
+            std::sort(perm_inv.begin(), perm_inv.end(),
+                      [this] (size_t k1, size_t k2) {
+                          return Label(label[k1]) < Label(label[k2]);
+                      });
+        }
+
+        std::vector<int> label;
+        std::vector<double> rho;
+        std::vector<int> nSV_;
+        std::vector<size_t> perm_inv;
+    };
+
+}
@@ -30,6 +30,9 @@
 #include <alps/hdf5/vector.hpp>
 
 #include <svm/dataset.hpp>
+#include <svm/model_summary.hpp>
+
+#include <svm/detail/linear_weights.hpp>
 
 #include <svm/libsvm/svm.h>
 
@@ -46,8 +49,11 @@ namespace serialization {
     template <typename Model>
     struct model_serializer<hdf5_tag, Model> {
 
-        model_serializer (Model & m)
-            : model_(m), prob_serializer(m.prob, !problem_t::is_precomputed) {}
+        // For the linear kernel, only the weight vector of each classifier is
+        // saved, unless support_vectors is set. Either form can be loaded.
+        model_serializer (Model & m, bool support_vectors = false)
+            : model_(m), prob_serializer(m.prob, !problem_t::is_precomputed),
+              support_vectors(support_vectors) {}
 
         void save (std::string const& filename) const {
             alps::hdf5::archive ar(filename, "w");
@@ -71,6 +77,9 @@ namespace serialization {
             if(param.kernel_type == POLY || param.kernel_type == SIGMOID)
                 ar["param/coef0"] << param.coef0;
 
+            if (param.svm_type == NU_SVC || param.svm_type == NU_SVR || param.svm_type == ONE_CLASS)
+                ar["param/nu"] << param.nu;
+
             int nr_class = model_.m->nr_class;
             int nr_sum = nr_class*(nr_class-1)/2;
             int l = model_.m->l;
@@ -85,18 +94,23 @@ namespace serialization {
                 ar["label"] << label;
             }
 
+            // the archive may hold a previous model (output files are
+            // reopened without truncation); datasets which are not written
+            // below are removed lest load() pick them up
             if (model_.m->probA) // regression has probA only
             {
                 std::vector<double> probA(model_.m->probA,
                                           model_.m->probA + nr_sum);
                 ar["probA"] << probA;
-            }
+            } else
+                discard(ar, "probA");
             if(model_.m->probB)
             {
                 std::vector<double> probB(model_.m->probB,
                                           model_.m->probB + nr_sum);
                 ar["probB"] << probB;
-            }
+            } else
+                discard(ar, "probB");
 
             if(model_.m->nSV)
             {
@@ -104,6 +118,30 @@ namespace serialization {
                 ar["nSV"] << nSV;
             }
 
+            if (param.kernel_type == LINEAR && !support_vectors) {
+                for (const char * name : {"sv_coef", "SV", "sv_indices",
+                                          "l_train", "checksum_train"})
+                    discard(ar, name);
+                boost::multi_array<double,2> W(boost::extents[nr_sum][model_.prob.dim()]);
+                detail::linear_weights(model_.m, model_.prob.dim(), W.data());
+                ar["W"] << W;
+                return;
+            }
+
+            discard(ar, "W");
+
+            // allows for warm-starting from the model on an extended problem
+            if (model_.m->sv_indices) {
+                std::vector<int> sv_indices(model_.m->sv_indices,
+                                            model_.m->sv_indices + l);
+                ar["sv_indices"] << sv_indices;
+                ar["l_train"] << model_.m->l_train;
+                ar["checksum_train"] << model_.m->checksum_train;
+            } else {
+                for (const char * name : {"sv_indices", "l_train", "checksum_train"})
+                    discard(ar, name);
+            }
+
             const double * const *sv_coef = model_.m->sv_coef;
             const svm_node * const *SV = model_.m->SV;
 
@@ -114,21 +152,35 @@ namespace serialization {
                         sv_coefm[i][j] = sv_coef[j][i];
                 ar["sv_coef"] << sv_coefm;
             }
+            // a previous model may have stored the SVs in the other form
+            // (dense dataset or CSR group), which cannot be overwritten
+            discard(ar, "SV");
             if (param.kernel_type == PRECOMPUTED) {
                 boost::multi_array<double,2> SVm(boost::extents[l][1]);
                 for (int i = 0; i < l; ++i)
                     SVm[i][0] = SV[i]->value;
                 ar["SV"] << SVm;
             } else {
-                boost::multi_array<double,2> SVm(boost::extents[l][model_.prob.dim()]);
+                // the SVs are stored in compressed sparse row format
+                std::vector<size_t> indptr(l + 1, 0);
+                for (int i = 0; i < l; ++i) {
+                    size_t nnz = 0;
+                    for (const svm_node * p = SV[i]; p->index != -1; ++p)
+                        ++nnz;
+                    indptr[i + 1] = indptr[i] + nnz;
+                }
+                std::vector<int> indices(indptr[l]);
+                std::vector<double> values(indptr[l]);
                 for (int i = 0; i < l; ++i) {
-                    svm::data_view v(SV[i]);
-                    auto it = v.begin();
-                    for (int j = 1; it != v.end(); ++j, ++it) {
-                        SVm[i][j-1] = *it;
+                    size_t k = indptr[i];
+                    for (const svm_node * p = SV[i]; p->index != -1; ++p, ++k) {
+                        indices[k] = p->index;
+                        values[k] = p->value;
                     }
                 }
-                ar["SV"] << SVm;
+                ar["SV/indptr"] << indptr;
+                ar["SV/indices"] << indices;
+                ar["SV/values"] << values;
             }
         }
 
@@ -144,6 +196,8 @@ namespace serialization {
                 svm_free_and_destroy_model(&model_.m);
 
             model_.m = (struct svm_model *)malloc(sizeof(struct svm_model));
+            model_.m->cache_hits = 0;
+            model_.m->cache_misses = 0;
 
             struct svm_parameter& param = model_.m->param;
             // parameters for training only won't be assigned, but arrays are
@@ -151,6 +205,10 @@ namespace serialization {
             param.nr_weight = 0;
             param.weight_label = NULL;
             param.weight = NULL;
+            param.dual_cd = 0;
+            param.gram = GRAM_NONE;
+            param.warm_start = NULL;
+            param.scheduler = NULL;
 
             ar["param/svm_type"] >> param.svm_type;
             ar["param/kernel_type"] >> param.kernel_type;
@@ -160,6 +218,10 @@ namespace serialization {
                 ar["param/gamma"] >> param.gamma;
             if(param.kernel_type == POLY || param.kernel_type == SIGMOID)
                 ar["param/coef0"] >> param.coef0;
+            if (ar.is_data("param/nu"))
+                ar["param/nu"] >> param.nu;
+            else
+                param.nu = 0;
 
             std::vector<double> rho;
             ar["rho"] >> rho;
@@ -202,6 +264,19 @@ namespace serialization {
             } else
                 model_.m->probB = nullptr;
 
+            model_.m->l_train = 0;
+            model_.m->checksum_train = 0;
+            if (ar.is_data("W")) {
+                boost::multi_array<double,2> W;
+                ar["W"] >> W;
+                if (W.shape()[0] != nr_sum || W.shape()[1] != model_.prob.dim())
+                    throw std::runtime_error("inconsistent data length");
+                detail::linear_model_from_weights(model_.m, model_.prob.dim(), W.data());
+                model_.params_ = typename Model::parameters_t(model_.m->param);
+                model_.init_perm();
+                return;
+            }
+
             std::vector<int> nSV;
             ar["nSV"] >> nSV;
             if (nSV.size() != nr_class)
@@ -211,19 +286,27 @@ namespace serialization {
 
             boost::multi_array<double,2> sv_coefm;
             ar["sv_coef"] >> sv_coefm;
-            boost::multi_array<double,2> SVm;
-            ar["SV"] >> SVm;
 
             size_t l = sv_coefm.shape()[0];
             if (sv_coefm.shape()[1] != nr_class-1)
                 throw std::runtime_error("inconsistent data length");
-            if (SVm.shape()[0] != l)
-                throw std::runtime_error("inconsistent data length");
-            size_t expected_size = Model::problem_t::is_precomputed ? 1 : model_.prob.dim();
-            if (SVm.shape()[1] != expected_size)
-                throw std::runtime_error("inconsistent data length");
             model_.m->l = l;
 
+            if (ar.is_data("sv_indices")) {
+                std::vector<int> sv_indices;
+                ar["sv_indices"] >> sv_indices;
+                if (sv_indices.size() != l)
+                    throw std::runtime_error("inconsistent data length");
+                model_.m->sv_indices = (int *)malloc(sizeof(int) * l);
+                std::copy(sv_indices.begin(), sv_indices.end(), model_.m->sv_indices);
+                // without the checksum, the training set cannot be
+                // verified: the model can only be warm-started from
+                if (ar.is_data("checksum_train")) {
+                    ar["l_train"] >> model_.m->l_train;
+                    ar["checksum_train"] >> model_.m->checksum_train;
+                }
+            }
+
             model_.m->sv_coef = (double **)malloc(sizeof(double *) * (nr_class-1));
             for (size_t j = 0; j < nr_class-1; ++j) {
                 model_.m->sv_coef[j] = (double *)malloc(sizeof(double) * l);
@@ -233,6 +316,68 @@ namespace serialization {
             }
 
             model_.m->SV = (struct svm_node **)malloc(sizeof(struct svm_node *) * l);
+            if (ar.is_group("SV"))
+                load_sparse_sv(ar, l);
+            else
+                load_dense_sv(ar, l);
+
+            model_.m->free_sv = 1;
+            model_.params_ = typename Model::parameters_t(model_.m->param);
+            model_.init_perm();
+        }
+
+    private:
+        // removes the dataset or group at path, if any
+        static void discard (alps::hdf5::archive & ar, std::string const& path) {
+            if (ar.is_group(path))
+                ar.delete_group(path);
+            else if (ar.is_data(path))
+                ar.delete_data(path);
+        }
+
+        // builds the SVs in a single arena directly from the CSR datasets
+        void load_sparse_sv (alps::hdf5::archive & ar, size_t l) {
+            std::vector<size_t> indptr;
+            std::vector<int> indices;
+            std::vector<double> values;
+            ar["SV/indptr"] >> indptr;
+            ar["SV/indices"] >> indices;
+            ar["SV/values"] >> values;
+            if (indptr.size() != l + 1 || indptr[0] != 0)
+                throw std::runtime_error("inconsistent data length");
+            size_t nnz = indptr[l];
+            if (indices.size() != nnz || values.size() != nnz)
+                throw std::runtime_error("inconsistent data length");
+            for (size_t i = 0; i < l; ++i)
+                if (indptr[i + 1] < indptr[i])
+                    throw std::runtime_error("inconsistent sparse row pointers");
+            int dim = model_.prob.dim();
+            for (int j : indices)
+                if (j < 1 || j > dim)
+                    throw std::runtime_error("inconsistent data dimension");
+
+            struct svm_node * SVmem = (struct svm_node *)malloc(sizeof(struct svm_node) * (nnz + l));
+            for (size_t i = 0; i < l; ++i) {
+                struct svm_node * p = SVmem + indptr[i] + i;
+                model_.m->SV[i] = p;
+                for (size_t k = indptr[i]; k < indptr[i + 1]; ++k, ++p) {
+                    p->index = indices[k];
+                    p->value = values[k];
+                }
+                p->index = -1;
+            }
+        }
+
+        // precomputed kernels and archives predating the CSR format
+        void load_dense_sv (alps::hdf5::archive & ar, size_t l) {
+            boost::multi_array<double,2> SVm;
+            ar["SV"] >> SVm;
+            if (SVm.shape()[0] != l)
+                throw std::runtime_error("inconsistent data length");
+            size_t expected_size = Model::problem_t::is_precomputed ? 1 : model_.prob.dim();
+            if (SVm.shape()[1] != expected_size)
+                throw std::runtime_error("inconsistent data length");
+
             struct svm_node * SVmem = (struct svm_node *)malloc(sizeof(struct svm_node) * l * (expected_size + 1));
             size_t start_index = Model::problem_t::is_precomputed ? 0 : 1;
             for (size_t i = 0; i < l; ++i) {
@@ -240,16 +385,44 @@ namespace serialization {
                 model_.m->SV[i] = SVmem + i * (expected_size + 1);
                 std::copy(ds.data().begin(), ds.data().end(), model_.m->SV[i]);
             }
-
-            model_.m->free_sv = 1;
-            model_.params_ = typename Model::parameters_t(model_.m->param);
-            model_.init_perm();
         }
 
-    private:
         using problem_t = typename Model::problem_t;
         Model & model_;
         problem_serializer<hdf5_tag, problem_t> prob_serializer;
+        bool support_vectors;
+    };
+
+    // Reads only the biases, labels and numbers of SVs of a saved model,
+    // leaving the problem, the SVs and their coefficients on disk.
+    template <typename Label>
+    struct model_serializer<hdf5_tag, model_summary<Label>> {
+
+        model_serializer (model_summary<Label> & s) : summary_(s) {}
+
+        void load (std::string const& filename) {
+            alps::hdf5::archive ar(filename, "r");
+            load(ar);
+        }
+
+        void load (alps::hdf5::archive & ar) {
+            model_summary<Label> s;
+            ar["rho"] >> s.rho;
+            ar["label"] >> s.label;
+            size_t nr_class = s.label.size();
+            if (s.rho.size() != nr_class * (nr_class-1) / 2)
+                throw std::runtime_error("inconsistent data length");
+            if (ar.is_data("nSV")) {
+                ar["nSV"] >> s.nSV_;
+                if (s.nSV_.size() != nr_class)
+                    throw std::runtime_error("inconsistent data length");
+            }
+            s.init_perm();
+            summary_ = std::move(s);
+        }
+
+    private:
+        model_summary<Label> & summary_;
     };
 
     template <class Problem>
@@ -274,19 +447,36 @@ namespace serialization {
             ar["dim"] << prob_.dim();
 
             if (full) {
-                boost::multi_array<double, 2> orig_data(boost::extents[prob_.size()][prob_.dim()]);
-                boost::multi_array<double, 2> labels(boost::extents[prob_.size()][ltraits::label_dim]);
-
-                for (size_t i = 0; i < prob_.size(); ++i) {
-                    auto p = prob_[i];
-                    view_t xs = p.first;
-                    label_t const& l = p.second;
-                    std::copy(xs.begin(), xs.end(), orig_data[i].begin());
-                    std::copy(ltraits::begin(l), ltraits::end(l), labels[i].begin());
+                size_t n = prob_.size(), dim = prob_.dim();
+                size_t ldim = ltraits::label_dim;
+                if (n == 0) {
+                    ar["orig_data"] << boost::multi_array<double, 2>(boost::extents[0][dim]);
+                    ar["labels"] << boost::multi_array<double, 2>(boost::extents[0][ldim]);
+                    return;
                 }
 
-                ar["orig_data"] << orig_data;
-                ar["labels"] << labels;
+                // the datasets are written in blocks of rows, such that only
+                // one block is held densely at a time
+                if (ar.is_data("orig_data"))
+                    ar.delete_data("orig_data");
+                if (ar.is_data("labels"))
+                    ar.delete_data("labels");
+                size_t rows = std::min(n, chunk_rows(dim));
+                std::vector<double> orig_data(rows * dim);
+                std::vector<double> labels(rows * ldim);
+                for (size_t i0 = 0; i0 < n; i0 += rows) {
+                    size_t nb = std::min(rows, n - i0);
+                    std::fill(orig_data.begin(), orig_data.end(), 0.);
+                    for (size_t i = 0; i < nb; ++i) {
+                        auto p = prob_[i0 + i];
+                        view_t xs = p.first;
+                        label_t const& l = p.second;
+                        std::copy(xs.begin(), xs.end(), &orig_data[i * dim]);
+                        std::copy(ltraits::begin(l), ltraits::end(l), &labels[i * ldim]);
+                    }
+                    ar.write("orig_data", orig_data.data(), {n, dim}, {nb, dim}, {i0, 0});
+                    ar.write("labels", labels.data(), {n, ldim}, {nb, ldim}, {i0, 0});
+                }
             }
         }
 
@@ -305,28 +495,43 @@ namespace serialization {
             Problem prob(dim);
 
             if (full) {
-                boost::multi_array<double, 2> orig_data;
-                boost::multi_array<double, 2> labels;
-                ar["orig_data"] >> orig_data;
-                ar["labels"] >> labels;
-
-                if (orig_data.shape()[0] != labels.shape()[0])
+                std::vector<size_t> data_extent = ar.extent("orig_data");
+                std::vector<size_t> labels_extent = ar.extent("labels");
+                if (data_extent.size() != 2 || labels_extent.size() != 2)
+                    throw std::runtime_error("inconsistent data rank");
+                size_t n = data_extent[0], ldim = ltraits::label_dim;
+                if (labels_extent[0] != n)
                     throw std::runtime_error("inconsistent data length");
-                if (orig_data.shape()[1] != dim)
+                if (data_extent[1] != dim)
                     throw std::runtime_error("inconsistent data dimension");
-                if (labels.shape()[1] != ltraits::label_dim)
+                if (labels_extent[1] != ldim)
                     throw std::runtime_error("inconsistent label dimension");
 
-                for (size_t i = 0; i < labels.shape()[0]; ++i)
-                    prob.add_sample(input_t(orig_data[i].begin(),
-                                            orig_data[i].end()),
-                                    ltraits::from_iterator(labels[i].begin()));
+                // read in blocks of rows, see save()
+                prob.reserve(n);
+                size_t rows = std::min(n, chunk_rows(dim));
+                std::vector<double> orig_data(rows * dim);
+                std::vector<double> labels(rows * ldim);
+                for (size_t i0 = 0; i0 < n; i0 += rows) {
+                    size_t nb = std::min(rows, n - i0);
+                    ar.read("orig_data", orig_data.data(), {nb, dim}, {i0, 0});
+                    ar.read("labels", labels.data(), {nb, ldim}, {i0, 0});
+                    for (size_t i = 0; i < nb; ++i)
+                        prob.add_sample(input_t(&orig_data[i * dim],
+                                                &orig_data[(i + 1) * dim]),
+                                        ltraits::from_iterator(&labels[i * ldim]));
+                }
             }
 
             prob_ = std::move(prob);
         }
 
     private:
+        // number of rows per block of about 8 MiB
+        static size_t chunk_rows (size_t dim) {
+            return std::max<size_t>(1, (size_t(1) << 20) / std::max<size_t>(dim, 1));
+        }
+
         Problem & prob_;
         bool full;
     };
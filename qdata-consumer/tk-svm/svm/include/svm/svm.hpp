@@ -22,6 +22,7 @@
 #include <svm/kernel.hpp>
 #include <svm/label.hpp>
 #include <svm/model.hpp>
+#include <svm/model_summary.hpp>
 #include <svm/problem.hpp>
 #include <svm/parameters.hpp>
 #include <svm/serialization/ascii.hpp>
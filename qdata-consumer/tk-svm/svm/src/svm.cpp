@@ -37,7 +37,13 @@
 #include <string.h>
 #include <stdarg.h>
 #include <limits.h>
+#include <stdint.h>
 #include <locale.h>
+#include <algorithm>
+#include <atomic>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 #include <svm/libsvm/svm.h>
 int libsvm_version = LIBSVM_VERSION;
 typedef float Qfloat;
@@ -69,6 +75,16 @@ static inline double powi(double base, int times)
 #define TAU 1e-12
 #define Malloc(type,n) (type *)malloc((n)*sizeof(type))
 
+// Loops over the variables of a single optimization problem are parallelized
+// only if there are sufficiently many of them and no other pairs are being
+// solved concurrently (used in OpenMP if-clauses only); sums are taken over
+// blocks of fixed size, such that they do not depend on the number of threads
+#ifndef PARALLEL_MIN_L
+#define PARALLEL_MIN_L 20000
+#endif
+#define PARALLEL_LOOP(n) ((n) >= PARALLEL_MIN_L && !omp_in_parallel())
+#define PARALLEL_BLOCK 1024
+
 static void print_string_stdout(const char *s)
 {
 	fputs(s,stdout);
@@ -91,14 +107,52 @@ static void info(const char *,...) {}
 
 //
 // Kernel Cache
+//
+// Kernel cache memory shared by concurrently solved subproblems
+//
+// The total size (in bytes) is split among all caches currently attached
+// to the budget, in proportion to their weight l^2. As subproblems start or
+// finish, the share of each cache is rebalanced on its next access.
+// Hit and miss counts of the attached caches are accumulated as well.
+//
+class Cache_Budget
+{
+public:
+	Cache_Budget(long int size_):size(size_),total_weight(0),hits(0),misses(0) {}
+
+	void attach(long long weight) { total_weight += weight; }
+	void detach(long long weight, long int h, long int m)
+	{
+		total_weight -= weight;
+		hits += h;
+		misses += m;
+	}
+
+	long int share(long long weight) const
+	{
+		long long total = total_weight;
+		if(total <= weight)
+			return size;
+		return (long int)((double)size*weight/total);
+	}
+
+	long int nr_hits() const { return hits; }
+	long int nr_misses() const { return misses; }
+private:
+	long int size;
+	std::atomic<long long> total_weight;
+	std::atomic<long int> hits, misses;
+};
+
 //
 // l is the number of total data items
 // size is the cache size limit in bytes
+// if a budget is given, size is ignored and the share of the budget is used
 //
 class Cache
 {
 public:
-	Cache(int l,long int size);
+	Cache(int l,long int size,Cache_Budget *budget = NULL);
 	~Cache();
 
 	// request data [0,len)
@@ -109,6 +163,9 @@ public:
 private:
 	int l;
 	long int size;
+	long int used;
+	Cache_Budget *budget;
+	long int hits, misses;
 	struct head_t
 	{
 		head_t *prev, *next;	// a circular list
@@ -120,15 +177,16 @@ private:
 	head_t lru_head;
 	void lru_delete(head_t *h);
 	void lru_insert(head_t *h);
+	long int capacity() const;
 };
 
-Cache::Cache(int l_,long int size_):l(l_),size(size_)
+Cache::Cache(int l_,long int size_,Cache_Budget *budget_)
+:l(l_),size(size_),used(0),budget(budget_),hits(0),misses(0)
 {
 	head = (head_t *)calloc(l,sizeof(head_t));	// initialized to 0
-	size /= sizeof(Qfloat);
-	size -= l * sizeof(head_t) / sizeof(Qfloat);
-	size = max(size, 2 * (long int) l);	// cache must be large enough for two columns
 	lru_head.next = lru_head.prev = &lru_head;
+	if(budget)
+		budget->attach((long long)l*l);
 }
 
 Cache::~Cache()
@@ -136,6 +194,17 @@ Cache::~Cache()
 	for(head_t *h = lru_head.next; h != &lru_head; h=h->next)
 		free(h->data);
 	free(head);
+	if(budget)
+		budget->detach((long long)l*l,hits,misses);
+}
+
+// cache size limit in units of Qfloat
+long int Cache::capacity() const
+{
+	long int cap = budget ? budget->share((long long)l*l) : size;
+	cap /= sizeof(Qfloat);
+	cap -= l * sizeof(head_t) / sizeof(Qfloat);
+	return max(cap, 2 * (long int) l);	// cache must be large enough for two columns
 }
 
 void Cache::lru_delete(head_t *h)
@@ -162,22 +231,27 @@ int Cache::get_data(const int index, Qfloat **data, int len)
 
 	if(more > 0)
 	{
+		++misses;
+
 		// free old space
-		while(size < more)
+		long int cap = capacity();
+		while(used + more > cap && lru_head.next != &lru_head)
 		{
 			head_t *old = lru_head.next;
 			lru_delete(old);
 			free(old->data);
-			size += old->len;
+			used -= old->len;
 			old->data = 0;
 			old->len = 0;
 		}
 
 		// allocate new space
 		h->data = (Qfloat *)realloc(h->data,sizeof(Qfloat)*len);
-		size -= more;
+		used += more;
 		swap(h->len,len);
 	}
+	else
+		++hits;
 
 	lru_insert(h);
 	*data = h->data;
@@ -207,7 +281,7 @@ void Cache::swap_index(int i, int j)
 				// give up
 				lru_delete(h);
 				free(h->data);
-				size += h->len;
+				used -= h->len;
 				h->data = 0;
 				h->len = 0;
 			}
@@ -499,22 +573,44 @@ void Solver::reconstruct_gradient()
 	int i,j;
 	int nr_free = 0;
 
+#pragma omp parallel for schedule(static) if(PARALLEL_LOOP(l-active_size))
 	for(j=active_size;j<l;j++)
 		G[j] = G_bar[j] + p[j];
 
+#pragma omp parallel for schedule(static) reduction(+:nr_free) if(PARALLEL_LOOP(active_size))
 	for(j=0;j<active_size;j++)
 		if(is_free(j))
 			nr_free++;
 
 	if (nr_free*l > 2*active_size*(l-active_size))
 	{
+		int nr_blocks = (active_size+PARALLEL_BLOCK-1)/PARALLEL_BLOCK;
+		double *G_block = Malloc(double,nr_blocks);
+		const Qfloat *Q_i = NULL;
+#pragma omp parallel private(i,j) if(PARALLEL_LOOP(active_size))
 		for(i=active_size;i<l;i++)
 		{
-			const Qfloat *Q_i = Q->get_Q(i,active_size);
-			for(j=0;j<active_size;j++)
-				if(is_free(j))
-					G[i] += alpha[j] * Q_i[j];
+#pragma omp single
+			Q_i = Q->get_Q(i,active_size);
+#pragma omp for schedule(static)
+			for(int b=0;b<nr_blocks;b++)
+			{
+				double G_b = 0;
+				int end = min(active_size,(b+1)*PARALLEL_BLOCK);
+				for(j=b*PARALLEL_BLOCK;j<end;j++)
+					if(is_free(j))
+						G_b += alpha[j] * Q_i[j];
+				G_block[b] = G_b;
+			}
+#pragma omp single
+			{
+				double G_i = 0;
+				for(int b=0;b<nr_blocks;b++)
+					G_i += G_block[b];
+				G[i] += G_i;
+			}
 		}
+		free(G_block);
 	}
 	else
 	{
@@ -523,6 +619,7 @@ void Solver::reconstruct_gradient()
 			{
 				const Qfloat *Q_i = Q->get_Q(i,l);
 				double alpha_i = alpha[i];
+#pragma omp parallel for schedule(static) if(PARALLEL_LOOP(l-active_size))
 				for(j=active_size;j<l;j++)
 					G[j] += alpha_i * Q_i[j];
 			}
@@ -575,11 +672,16 @@ void Solver::Solve(int l, const QMatrix& Q, const double *p_, const schar *y_,
 				const Qfloat *Q_i = Q.get_Q(i,l);
 				double alpha_i = alpha[i];
 				int j;
+#pragma omp parallel for schedule(static) if(PARALLEL_LOOP(l))
 				for(j=0;j<l;j++)
 					G[j] += alpha_i*Q_i[j];
 				if(is_upper_bound(i))
+				{
+					double C_i = get_C(i);
+#pragma omp parallel for schedule(static) if(PARALLEL_LOOP(l))
 					for(j=0;j<l;j++)
-						G_bar[j] += get_C(i) * Q_i[j];
+						G_bar[j] += C_i * Q_i[j];
+				}
 			}
 	}
 
@@ -719,6 +821,7 @@ void Solver::Solve(int l, const QMatrix& Q, const double *p_, const schar *y_,
 		double delta_alpha_i = alpha[i] - old_alpha_i;
 		double delta_alpha_j = alpha[j] - old_alpha_j;
 		
+#pragma omp parallel for schedule(static) if(PARALLEL_LOOP(active_size))
 		for(int k=0;k<active_size;k++)
 		{
 			G[k] += Q_i[k]*delta_alpha_i + Q_j[k]*delta_alpha_j;
@@ -735,23 +838,19 @@ void Solver::Solve(int l, const QMatrix& Q, const double *p_, const schar *y_,
 			if(ui != is_upper_bound(i))
 			{
 				Q_i = Q.get_Q(i,l);
-				if(ui)
-					for(k=0;k<l;k++)
-						G_bar[k] -= C_i * Q_i[k];
-				else
-					for(k=0;k<l;k++)
-						G_bar[k] += C_i * Q_i[k];
+				double dC_i = ui ? -C_i : C_i;
+#pragma omp parallel for schedule(static) if(PARALLEL_LOOP(l))
+				for(k=0;k<l;k++)
+					G_bar[k] += dC_i * Q_i[k];
 			}
 
 			if(uj != is_upper_bound(j))
 			{
 				Q_j = Q.get_Q(j,l);
-				if(uj)
-					for(k=0;k<l;k++)
-						G_bar[k] -= C_j * Q_j[k];
-				else
-					for(k=0;k<l;k++)
-						G_bar[k] += C_j * Q_j[k];
+				double dC_j = uj ? -C_j : C_j;
+#pragma omp parallel for schedule(static) if(PARALLEL_LOOP(l))
+				for(k=0;k<l;k++)
+					G_bar[k] += dC_j * Q_j[k];
 			}
 		}
 	}
@@ -819,87 +918,122 @@ int Solver::select_working_set(int &out_i, int &out_j)
 	//    (if quadratic coefficeint <= 0, replace it with tau)
 	//    -y_j*grad(f)_j < -y_i*grad(f)_i, j in I_low(\alpha)
 	
+	//
+	// In parallel, each thread searches a contiguous range of indices and
+	// ties are resolved towards the largest index when merging, as in the
+	// serial loop. Hence, the selection does not depend on the number of
+	// threads.
+	
 	double Gmax = -INF;
 	double Gmax2 = -INF;
 	int Gmax_idx = -1;
 	int Gmin_idx = -1;
 	double obj_diff_min = INF;
 
-	for(int t=0;t<active_size;t++)
-		if(y[t]==+1)	
-		{
-			if(!is_upper_bound(t))
-				if(-G[t] >= Gmax)
-				{
-					Gmax = -G[t];
-					Gmax_idx = t;
-				}
-		}
-		else
+#pragma omp parallel if(PARALLEL_LOOP(active_size))
+	{
+		double Gmax_t = -INF;
+		int Gmax_idx_t = -1;
+#pragma omp for schedule(static) nowait
+		for(int t=0;t<active_size;t++)
+			if(y[t]==+1)	
+			{
+				if(!is_upper_bound(t))
+					if(-G[t] >= Gmax_t)
+					{
+						Gmax_t = -G[t];
+						Gmax_idx_t = t;
+					}
+			}
+			else
+			{
+				if(!is_lower_bound(t))
+					if(G[t] >= Gmax_t)
+					{
+						Gmax_t = G[t];
+						Gmax_idx_t = t;
+					}
+			}
+#pragma omp critical
+		if(Gmax_t > Gmax || (Gmax_t == Gmax && Gmax_idx_t > Gmax_idx))
 		{
-			if(!is_lower_bound(t))
-				if(G[t] >= Gmax)
-				{
-					Gmax = G[t];
-					Gmax_idx = t;
-				}
+			Gmax = Gmax_t;
+			Gmax_idx = Gmax_idx_t;
 		}
+	}
 
 	int i = Gmax_idx;
 	const Qfloat *Q_i = NULL;
 	if(i != -1) // NULL Q_i not accessed: Gmax=-INF if i=-1
 		Q_i = Q->get_Q(i,active_size);
 
-	for(int j=0;j<active_size;j++)
+#pragma omp parallel if(PARALLEL_LOOP(active_size))
 	{
-		if(y[j]==+1)
+		double Gmax2_t = -INF;
+		int Gmin_idx_t = -1;
+		double obj_diff_min_t = INF;
+#pragma omp for schedule(static) nowait
+		for(int j=0;j<active_size;j++)
 		{
-			if (!is_lower_bound(j))
+			if(y[j]==+1)
 			{
-				double grad_diff=Gmax+G[j];
-				if (G[j] >= Gmax2)
-					Gmax2 = G[j];
-				if (grad_diff > 0)
+				if (!is_lower_bound(j))
 				{
-					double obj_diff;
-					double quad_coef = QD[i]+QD[j]-2.0*y[i]*Q_i[j];
-					if (quad_coef > 0)
-						obj_diff = -(grad_diff*grad_diff)/quad_coef;
-					else
-						obj_diff = -(grad_diff*grad_diff)/TAU;
-
-					if (obj_diff <= obj_diff_min)
+					double grad_diff=Gmax+G[j];
+					if (G[j] >= Gmax2_t)
+						Gmax2_t = G[j];
+					if (grad_diff > 0)
 					{
-						Gmin_idx=j;
-						obj_diff_min = obj_diff;
+						double obj_diff;
+						double quad_coef = QD[i]+QD[j]-2.0*y[i]*Q_i[j];
+						if (quad_coef > 0)
+							obj_diff = -(grad_diff*grad_diff)/quad_coef;
+						else
+							obj_diff = -(grad_diff*grad_diff)/TAU;
+
+						if (obj_diff <= obj_diff_min_t)
+						{
+							Gmin_idx_t=j;
+							obj_diff_min_t = obj_diff;
+						}
 					}
 				}
 			}
-		}
-		else
-		{
-			if (!is_upper_bound(j))
+			else
 			{
-				double grad_diff= Gmax-G[j];
-				if (-G[j] >= Gmax2)
-					Gmax2 = -G[j];
-				if (grad_diff > 0)
+				if (!is_upper_bound(j))
 				{
-					double obj_diff;
-					double quad_coef = QD[i]+QD[j]+2.0*y[i]*Q_i[j];
-					if (quad_coef > 0)
-						obj_diff = -(grad_diff*grad_diff)/quad_coef;
-					else
-						obj_diff = -(grad_diff*grad_diff)/TAU;
-
-					if (obj_diff <= obj_diff_min)
+					double grad_diff= Gmax-G[j];
+					if (-G[j] >= Gmax2_t)
+						Gmax2_t = -G[j];
+					if (grad_diff > 0)
 					{
-						Gmin_idx=j;
-						obj_diff_min = obj_diff;
+						double obj_diff;
+						double quad_coef = QD[i]+QD[j]+2.0*y[i]*Q_i[j];
+						if (quad_coef > 0)
+							obj_diff = -(grad_diff*grad_diff)/quad_coef;
+						else
+							obj_diff = -(grad_diff*grad_diff)/TAU;
+
+						if (obj_diff <= obj_diff_min_t)
+						{
+							Gmin_idx_t=j;
+							obj_diff_min_t = obj_diff;
+						}
 					}
 				}
 			}
 		}
+#pragma omp critical
+		{
+			Gmax2 = max(Gmax2,Gmax2_t);
+			if(Gmin_idx_t != -1 && (obj_diff_min_t < obj_diff_min ||
+			   (obj_diff_min_t == obj_diff_min && Gmin_idx_t > Gmin_idx)))
+			{
+				Gmin_idx = Gmin_idx_t;
+				obj_diff_min = obj_diff_min_t;
+			}
+		}
 	}
 
 	if(Gmax+Gmax2 < eps || Gmin_idx == -1)
@@ -1073,25 +1207,48 @@ int Solver_NU::select_working_set(int &out_i, int &out_j)
 	int Gmin_idx = -1;
 	double obj_diff_min = INF;
 
-	for(int t=0;t<active_size;t++)
-		if(y[t]==+1)
-		{
-			if(!is_upper_bound(t))
-				if(-G[t] >= Gmaxp)
-				{
-					Gmaxp = -G[t];
-					Gmaxp_idx = t;
-				}
-		}
-		else
+	// parallel search as in Solver::select_working_set
+
+#pragma omp parallel if(PARALLEL_LOOP(active_size))
+	{
+		double Gmaxp_t = -INF;
+		int Gmaxp_idx_t = -1;
+		double Gmaxn_t = -INF;
+		int Gmaxn_idx_t = -1;
+#pragma omp for schedule(static) nowait
+		for(int t=0;t<active_size;t++)
+			if(y[t]==+1)
+			{
+				if(!is_upper_bound(t))
+					if(-G[t] >= Gmaxp_t)
+					{
+						Gmaxp_t = -G[t];
+						Gmaxp_idx_t = t;
+					}
+			}
+			else
+			{
+				if(!is_lower_bound(t))
+					if(G[t] >= Gmaxn_t)
+					{
+						Gmaxn_t = G[t];
+						Gmaxn_idx_t = t;
+					}
+			}
+#pragma omp critical
 		{
-			if(!is_lower_bound(t))
-				if(G[t] >= Gmaxn)
-				{
-					Gmaxn = G[t];
-					Gmaxn_idx = t;
-				}
+			if(Gmaxp_t > Gmaxp || (Gmaxp_t == Gmaxp && Gmaxp_idx_t > Gmaxp_idx))
+			{
+				Gmaxp = Gmaxp_t;
+				Gmaxp_idx = Gmaxp_idx_t;
+			}
+			if(Gmaxn_t > Gmaxn || (Gmaxn_t == Gmaxn && Gmaxn_idx_t > Gmaxn_idx))
+			{
+				Gmaxn = Gmaxn_t;
+				Gmaxn_idx = Gmaxn_idx_t;
+			}
 		}
+	}
 
 	int ip = Gmaxp_idx;
 	int in = Gmaxn_idx;
@@ -1102,56 +1259,75 @@ int Solver_NU::select_working_set(int &out_i, int &out_j)
 	if(in != -1)
 		Q_in = Q->get_Q(in,active_size);
 
-	for(int j=0;j<active_size;j++)
+#pragma omp parallel if(PARALLEL_LOOP(active_size))
 	{
-		if(y[j]==+1)
+		double Gmaxp2_t = -INF;
+		double Gmaxn2_t = -INF;
+		int Gmin_idx_t = -1;
+		double obj_diff_min_t = INF;
+#pragma omp for schedule(static) nowait
+		for(int j=0;j<active_size;j++)
 		{
-			if (!is_lower_bound(j))	
+			if(y[j]==+1)
 			{
-				double grad_diff=Gmaxp+G[j];
-				if (G[j] >= Gmaxp2)
-					Gmaxp2 = G[j];
-				if (grad_diff > 0)
+				if (!is_lower_bound(j))	
 				{
-					double obj_diff;
-					double quad_coef = QD[ip]+QD[j]-2*Q_ip[j];
-					if (quad_coef > 0)
-						obj_diff = -(grad_diff*grad_diff)/quad_coef;
-					else
-						obj_diff = -(grad_diff*grad_diff)/TAU;
-
-					if (obj_diff <= obj_diff_min)
+					double grad_diff=Gmaxp+G[j];
+					if (G[j] >= Gmaxp2_t)
+						Gmaxp2_t = G[j];
+					if (grad_diff > 0)
 					{
-						Gmin_idx=j;
-						obj_diff_min = obj_diff;
+						double obj_diff;
+						double quad_coef = QD[ip]+QD[j]-2*Q_ip[j];
+						if (quad_coef > 0)
+							obj_diff = -(grad_diff*grad_diff)/quad_coef;
+						else
+							obj_diff = -(grad_diff*grad_diff)/TAU;
+
+						if (obj_diff <= obj_diff_min_t)
+						{
+							Gmin_idx_t=j;
+							obj_diff_min_t = obj_diff;
+						}
 					}
 				}
 			}
-		}
-		else
-		{
-			if (!is_upper_bound(j))
+			else
 			{
-				double grad_diff=Gmaxn-G[j];
-				if (-G[j] >= Gmaxn2)
-					Gmaxn2 = -G[j];
-				if (grad_diff > 0)
+				if (!is_upper_bound(j))
 				{
-					double obj_diff;
-					double quad_coef = QD[in]+QD[j]-2*Q_in[j];
-					if (quad_coef > 0)
-						obj_diff = -(grad_diff*grad_diff)/quad_coef;
-					else
-						obj_diff = -(grad_diff*grad_diff)/TAU;
-
-					if (obj_diff <= obj_diff_min)
+					double grad_diff=Gmaxn-G[j];
+					if (-G[j] >= Gmaxn2_t)
+						Gmaxn2_t = -G[j];
+					if (grad_diff > 0)
 					{
-						Gmin_idx=j;
-						obj_diff_min = obj_diff;
+						double obj_diff;
+						double quad_coef = QD[in]+QD[j]-2*Q_in[j];
+						if (quad_coef > 0)
+							obj_diff = -(grad_diff*grad_diff)/quad_coef;
+						else
+							obj_diff = -(grad_diff*grad_diff)/TAU;
+
+						if (obj_diff <= obj_diff_min_t)
+						{
+							Gmin_idx_t=j;
+							obj_diff_min_t = obj_diff;
+						}
 					}
 				}
 			}
 		}
+#pragma omp critical
+		{
+			Gmaxp2 = max(Gmaxp2,Gmaxp2_t);
+			Gmaxn2 = max(Gmaxn2,Gmaxn2_t);
+			if(Gmin_idx_t != -1 && (obj_diff_min_t < obj_diff_min ||
+			   (obj_diff_min_t == obj_diff_min && Gmin_idx_t > Gmin_idx)))
+			{
+				Gmin_idx = Gmin_idx_t;
+				obj_diff_min = obj_diff_min_t;
+			}
+		}
 	}
 
 	if(max(Gmaxp+Gmaxp2,Gmaxn+Gmaxn2) < eps || Gmin_idx == -1)
@@ -1288,17 +1464,279 @@ double Solver_NU::calculate_rho()
 	return (r1-r2)/2;
 }
 
+//
+// Dual coordinate descent for nu-SVC with linear kernel
+//
+// Rather than evaluating columns of Q, the primal weight vector
+// w = \sum_i alpha_i y_i x_i is kept explicitly, such that
+// G_i = (Q alpha)_i = y_i w^T x_i costs O(#nonzeros of x_i) and no kernel
+// cache is needed. Since the nu-SVC dual constrains the sum of the alphas
+// in each class separately, variables are updated pairwise within a class:
+// the indices of either class are ranked by their gradient and those with
+// the smallest gradients are paired with those with the largest ones,
+// starting from the maximal violating pair. Each pair update is an exact
+// line minimization based on fresh gradients.
+//
+// In each outer iteration the gradient is refreshed for all variables and
+// the stopping criterion is checked. Variables which cannot be part of a
+// violating pair are shrunk away and the inner iterations only sweep the
+// remaining active set until it is optimal on its own.
+//
+// The stopping criterion and the calculation of rho and r are the same as
+// in Solver_NU, so the result can be rescaled just like in solve_nu_svc.
+//
+static void solve_nu_dcd(int l, const svm_node * const *x, const schar *y,
+	double *alpha, const svm_parameter *param, Solver::SolutionInfo* si)
+{
+	int i, k;
+	double eps = param->eps;
+	int max_iter = max(10000000, l>INT_MAX/100 ? INT_MAX : 100*l);
+	int max_inner_iter = 100;
+	int iter = 0;	// number of pair updates, as in Solver
+
+	int n = 0;
+	for(i=0;i<l;i++)
+		for(const svm_node *px = x[i]; px->index != -1; ++px)
+			n = max(n, px->index+1);
+
+	double *w = new double[n];
+	double *QD = new double[l];
+	double *G = new double[l];
+	int *index = new int[l];
+
+	for(k=0;k<n;k++)
+		w[k] = 0;
+	for(i=0;i<l;i++)
+	{
+		QD[i] = Kernel::k_function(x[i],x[i],*param);
+		if(alpha[i] > 0)
+			for(const svm_node *px = x[i]; px->index != -1; ++px)
+				w[px->index] += y[i]*alpha[i]*px->value;
+	}
+
+	auto gradient = [&](int i) {
+		double wx = 0;
+		for(const svm_node *px = x[i]; px->index != -1; ++px)
+			wx += w[px->index]*px->value;
+		return y[i]*wx;
+	};
+
+	// refreshes G on index[begin..end) and returns the maximal violation
+	auto violation = [&](int begin, int end, double& Gmax, double& Gmin) {
+		Gmax = -INF;
+		Gmin = INF;
+		for(int k=begin;k<end;k++)
+		{
+			int i = index[k];
+			G[i] = gradient(i);
+			if(alpha[i] > 0) Gmax = max(Gmax,G[i]);
+			if(alpha[i] < 1) Gmin = min(Gmin,G[i]);
+		}
+		return Gmax-Gmin;
+	};
+
+	// one sweep of pair updates over index[begin..end)
+	auto sweep = [&](int begin, int end) {
+		std::sort(index+begin, index+end,
+			[G](int a, int b) { return G[a] < G[b]; });
+
+		int lo = begin, hi = end-1;
+		while(1)
+		{
+			// alpha[i] is increased, alpha[j] decreased by the same amount
+			while(lo < hi && alpha[index[lo]] >= 1) ++lo;
+			while(lo < hi && alpha[index[hi]] <= 0) --hi;
+			if(lo >= hi)
+				break;
+			int i = index[lo];
+			int j = index[hi];
+			if(G[j] - G[i] < eps)
+				break;
+
+			double quad_coef = QD[i]+QD[j]-2*Kernel::k_function(x[i],x[j],*param);
+			if(quad_coef <= 0)
+				quad_coef = TAU;
+			double delta = (gradient(j)-gradient(i))/quad_coef;
+			if(delta <= 0)
+			{
+				++lo;
+				--hi;
+				continue;
+			}
+
+			bool i_at_bound = false, j_at_bound = false;
+			if(delta >= 1-alpha[i])
+			{
+				delta = 1-alpha[i];
+				i_at_bound = true;
+			}
+			if(delta >= alpha[j])
+			{
+				delta = alpha[j];
+				i_at_bound = (delta == 1-alpha[i]);
+				j_at_bound = true;
+			}
+			alpha[i] = i_at_bound ? 1 : alpha[i]+delta;
+			alpha[j] = j_at_bound ? 0 : alpha[j]-delta;
+			++iter;
+
+			for(const svm_node *px = x[i]; px->index != -1; ++px)
+				w[px->index] += y[i]*delta*px->value;
+			for(const svm_node *px = x[j]; px->index != -1; ++px)
+				w[px->index] -= y[j]*delta*px->value;
+
+			if(i_at_bound) ++lo;
+			if(j_at_bound) --hi;
+			if(!i_at_bound && !j_at_bound)
+			{
+				++lo;
+				--hi;
+			}
+		}
+	};
+
+	// indices of the positive class first, then those of the negative class
+	int nr_pos = 0;
+	for(i=0;i<l;i++)
+		if(y[i] == +1)
+			index[nr_pos++] = i;
+	for(i=0,k=nr_pos;i<l;i++)
+		if(y[i] != +1)
+			index[k++] = i;
+
+	while(1)
+	{
+		// refresh gradient and check stopping criterion on all variables
+		double Gmaxp, Gminp, Gmaxn, Gminn;
+		double diff_p = violation(0, nr_pos, Gmaxp, Gminp);
+		double diff_n = violation(nr_pos, l, Gmaxn, Gminn);
+		if(max(diff_p,diff_n) < eps)
+			break;
+
+		if(iter >= max_iter)
+		{
+			fprintf(stderr,"\nWARNING: reaching max number of iterations\n");
+			break;
+		}
+
+		// shrinking: move the active variables to the front of each class
+		int active_pos = 0, active_neg = nr_pos;
+		for(k=0;k<l;k++)
+		{
+			i = index[k];
+			double Gmax = (k < nr_pos) ? Gmaxp : Gmaxn;
+			double Gmin = (k < nr_pos) ? Gminp : Gminn;
+			if((alpha[i] < 1 && G[i] < Gmax) || (alpha[i] > 0 && G[i] > Gmin))
+			{
+				if(k < nr_pos)
+					swap(index[k],index[active_pos++]);
+				else
+					swap(index[k],index[active_neg++]);
+			}
+		}
+
+		int outer_start = iter;
+		for(int inner_iter=0;inner_iter<max_inner_iter;inner_iter++)
+		{
+			if(inner_iter > 0)
+			{
+				diff_p = violation(0, active_pos, Gmaxp, Gminp);
+				diff_n = violation(nr_pos, active_neg, Gmaxn, Gminn);
+				if(max(diff_p,diff_n) < eps)
+					break;
+			}
+			int last_iter = iter;
+			sweep(0, active_pos);
+			sweep(nr_pos, active_neg);
+			if(iter == last_iter || iter >= max_iter)
+				break;
+		}
+		if(iter == outer_start)
+		{
+			fprintf(stderr,"\nWARNING: no progress in dual coordinate descent\n");
+			break;
+		}
+	}
+
+	info("\noptimization finished, #iter = %d\n",iter);
+
+	// calculate rho and r as in Solver_NU::calculate_rho
+
+	int nr_free1 = 0,nr_free2 = 0;
+	double ub1 = INF, ub2 = INF;
+	double lb1 = -INF, lb2 = -INF;
+	double sum_free1 = 0, sum_free2 = 0;
+
+	for(i=0;i<l;i++)
+	{
+		if(y[i]==+1)
+		{
+			if(alpha[i] >= 1)
+				lb1 = max(lb1,G[i]);
+			else if(alpha[i] <= 0)
+				ub1 = min(ub1,G[i]);
+			else
+			{
+				++nr_free1;
+				sum_free1 += G[i];
+			}
+		}
+		else
+		{
+			if(alpha[i] >= 1)
+				lb2 = max(lb2,G[i]);
+			else if(alpha[i] <= 0)
+				ub2 = min(ub2,G[i]);
+			else
+			{
+				++nr_free2;
+				sum_free2 += G[i];
+			}
+		}
+	}
+
+	double r1,r2;
+	if(nr_free1 > 0)
+		r1 = sum_free1/nr_free1;
+	else
+		r1 = (ub1+lb1)/2;
+
+	if(nr_free2 > 0)
+		r2 = sum_free2/nr_free2;
+	else
+		r2 = (ub2+lb2)/2;
+
+	si->r = (r1+r2)/2;
+	si->rho = (r1-r2)/2;
+
+	// calculate objective value
+
+	double v = 0;
+	for(i=0;i<l;i++)
+		v += alpha[i] * G[i];
+	si->obj = v/2;
+
+	si->upper_bound_p = 1;
+	si->upper_bound_n = 1;
+
+	delete[] w;
+	delete[] QD;
+	delete[] G;
+	delete[] index;
+}
+
 //
 // Q matrices for various formulations
 //
 class SVC_Q: public Kernel
 { 
 public:
-	SVC_Q(const svm_problem& prob, const svm_parameter& param, const schar *y_)
+	SVC_Q(const svm_problem& prob, const svm_parameter& param, const schar *y_,
+		Cache_Budget *budget = NULL)
 	:Kernel(prob.l, prob.x, param)
 	{
 		clone(y,y_,prob.l);
-		cache = new Cache(prob.l,(long int)(param.cache_size*(1<<20)));
+		cache = new Cache(prob.l,(long int)(param.cache_size*(1<<20)),budget);
 		QD = new double[prob.l];
 		for(int i=0;i<prob.l;i++)
 			QD[i] = (this->*kernel_function)(i,i);
@@ -1310,6 +1748,7 @@ public:
 		int start, j;
 		if((start = cache->get_data(i,&data,len)) < len)
 		{
+#pragma omp parallel for schedule(static) if(PARALLEL_LOOP(len-start))
 			for(j=start;j<len;j++)
 				data[j] = (Qfloat)(y[i]*y[j]*(this->*kernel_function)(i,j));
 		}
@@ -1462,12 +1901,229 @@ private:
 	double *QD;
 };
 
+//
+// Gram matrix precomputed once for all samples of a multiclass problem
+//
+// In one-vs-one training, each sample takes part in nr_class-1 binary
+// problems. Rather than having each SVC_Q evaluate and cache the same kernel
+// values again, the full l*l kernel matrix can be calculated up front, in
+// either single or double precision (param.gram), and shared by all pairs.
+// If the matrix cannot be allocated, calculate_gram returns NULL and the
+// pairs fall back to evaluating their kernel columns on demand (GRAM_NONE).
+//
+struct gram_view
+{
+	const float *f;		// either f or d is non-NULL, depending on
+	const double *d;	// the precision requested in param.gram
+	int ld;			// total number of samples
+	const int *index;	// position of subproblem samples in the matrix
+};
+
+template <class T>
+static T *calculate_gram(int l, svm_node * const *x, const svm_parameter& param)
+{
+	T *K = (size_t)l > SIZE_MAX/sizeof(T)/max(l,1) ? NULL : Malloc(T,(size_t)l*l);
+	if(K == NULL)
+	{
+		info("WARNING: cannot allocate the %d x %d Gram matrix, computing kernel columns on demand\n",l,l);
+		return NULL;
+	}
+
+	if(param.kernel_type == PRECOMPUTED)
+	{
+#pragma omp parallel for schedule(static)
+		for(int i=0;i<l;i++)
+			for(int j=0;j<l;j++)
+				K[(size_t)i*l+j] = (T)x[i][(int)(x[j][0].value)].value;
+		return K;
+	}
+
+	// densify the samples, then calculate the dot products block-wise and
+	// apply the kernel function to each block
+	int n = 0;
+	for(int i=0;i<l;i++)
+		for(const svm_node *px = x[i]; px->index != -1; ++px)
+			n = max(n, px->index+1);
+	double *X = (size_t)l > SIZE_MAX/sizeof(double)/max(n,1) ? NULL : Malloc(double,(size_t)l*n);
+	if(X == NULL)
+	{
+		info("WARNING: cannot allocate the dense samples for the Gram matrix, computing kernel columns on demand\n");
+		free(K);
+		return NULL;
+	}
+	double *x_square = Malloc(double,l);
+	for(int i=0;i<l;i++)
+	{
+		double *Xi = X + (size_t)i*n;
+		for(int k=0;k<n;k++)
+			Xi[k] = 0;
+		x_square[i] = 0;
+		for(const svm_node *px = x[i]; px->index != -1; ++px)
+		{
+			Xi[px->index] = px->value;
+			x_square[i] += px->value*px->value;
+		}
+	}
+
+	const int bs = 64;
+	const int ks = 256;
+	int nb = (l+bs-1)/bs;
+#pragma omp parallel for schedule(dynamic,1)
+	for(int p=0;p<nb*(nb+1)/2;p++)
+	{
+		// enumerate the blocks (bi,bj) of the upper triangle, bi <= bj
+		int bi = 0, rest = p;
+		while(rest >= nb-bi)
+		{
+			rest -= nb-bi;
+			++bi;
+		}
+		int bj = bi+rest;
+		int i0 = bi*bs, i1 = min(i0+bs,l);
+		int j0 = bj*bs, j1 = min(j0+bs,l);
+
+		double tile[bs][bs];
+		for(int i=0;i<i1-i0;i++)
+			for(int j=0;j<j1-j0;j++)
+				tile[i][j] = 0;
+		for(int k0=0;k0<n;k0+=ks)
+		{
+			int k1 = min(k0+ks,n);
+			for(int i=i0;i<i1;i++)
+			{
+				const double *Xi = X + (size_t)i*n;
+				for(int j=j0;j<j1;j++)
+				{
+					const double *Xj = X + (size_t)j*n;
+					double sum = 0;
+					for(int k=k0;k<k1;k++)
+						sum += Xi[k]*Xj[k];
+					tile[i-i0][j-j0] += sum;
+				}
+			}
+		}
+
+		for(int i=i0;i<i1;i++)
+			for(int j=j0;j<j1;j++)
+			{
+				double dot = tile[i-i0][j-j0];
+				double k;
+				switch(param.kernel_type)
+				{
+					case POLY:
+						k = powi(param.gamma*dot+param.coef0,param.degree);
+						break;
+					case RBF:
+						k = exp(-param.gamma*(x_square[i]+x_square[j]-2*dot));
+						break;
+					case SIGMOID:
+						k = tanh(param.gamma*dot+param.coef0);
+						break;
+					default:
+						k = dot;
+				}
+				K[(size_t)i*l+j] = (T)k;
+				K[(size_t)j*l+i] = (T)k;
+			}
+	}
+
+	free(X);
+	free(x_square);
+	return K;
+}
+
+// like SVC_Q, but the cache is filled from the Gram matrix
+template <class T>
+class GRAM_Q: public QMatrix
+{
+public:
+	GRAM_Q(const T *gram, const gram_view& view, int l, const schar *y_,
+		const svm_parameter& param, Cache_Budget *budget)
+	:ld(view.ld), K(gram)
+	{
+		clone(y,y_,l);
+		clone(index,view.index,l);
+		cache = new Cache(l,(long int)(param.cache_size*(1<<20)),budget);
+		QD = new double[l];
+		for(int i=0;i<l;i++)
+			QD[i] = K[(size_t)index[i]*ld+index[i]];
+	}
+
+	Qfloat *get_Q(int i, int len) const
+	{
+		Qfloat *data;
+		int start, j;
+		if((start = cache->get_data(i,&data,len)) < len)
+		{
+			const T *row = K + (size_t)index[i]*ld;
+#pragma omp parallel for schedule(static) if(PARALLEL_LOOP(len-start))
+			for(j=start;j<len;j++)
+				data[j] = (Qfloat)(y[i]*y[j]*row[index[j]]);
+		}
+		return data;
+	}
+
+	double *get_QD() const
+	{
+		return QD;
+	}
+
+	void swap_index(int i, int j) const
+	{
+		cache->swap_index(i,j);
+		swap(y[i],y[j]);
+		swap(index[i],index[j]);
+		swap(QD[i],QD[j]);
+	}
+
+	~GRAM_Q()
+	{
+		delete[] y;
+		delete[] index;
+		delete cache;
+		delete[] QD;
+	}
+private:
+	int ld;
+	const T *K;
+	schar *y;
+	int *index;
+	Cache *cache;
+	double *QD;
+};
+
+//
+// auxiliary input to the solution of one pair in multiclass training
+//
+struct pair_context
+{
+	const gram_view *gram;	// precomputed Gram matrix, may be NULL
+	Cache_Budget *budget;	// shared kernel cache budget, may be NULL
+	const double *alpha;	// for NU_SVC: alphas to warm-start from (up to
+				// normalization and sign), may be NULL
+};
+
+// Q matrix for C-SVC and nu-SVC; a view into the Gram matrix if available
+static QMatrix *new_svc_q(const svm_problem *prob, const svm_parameter *param,
+	const schar *y, const pair_context *ctx)
+{
+	const gram_view *gram = ctx ? ctx->gram : NULL;
+	Cache_Budget *budget = ctx ? ctx->budget : NULL;
+	if(gram == NULL)
+		return new SVC_Q(*prob,*param,y,budget);
+	else if(gram->f)
+		return new GRAM_Q<float>(gram->f,*gram,prob->l,y,*param,budget);
+	else
+		return new GRAM_Q<double>(gram->d,*gram,prob->l,y,*param,budget);
+}
+
 //
 // construct and solve various formulations
 //
 static void solve_c_svc(
 	const svm_problem *prob, const svm_parameter* param,
-	double *alpha, Solver::SolutionInfo* si, double Cp, double Cn)
+	double *alpha, Solver::SolutionInfo* si, double Cp, double Cn,
+	const pair_context *ctx)
 {
 	int l = prob->l;
 	double *minus_ones = new double[l];
@@ -1482,9 +2138,11 @@ static void solve_c_svc(
 		if(prob->y[i] > 0) y[i] = +1; else y[i] = -1;
 	}
 
+	QMatrix *Q = new_svc_q(prob,param,y,ctx);
 	Solver s;
-	s.Solve(l, SVC_Q(*prob,*param,y), minus_ones, y,
+	s.Solve(l, *Q, minus_ones, y,
 		alpha, Cp, Cn, param->eps, si, param->shrinking);
+	delete Q;
 
 	double sum_alpha=0;
 	for(i=0;i<l;i++)
@@ -1500,9 +2158,67 @@ static void solve_c_svc(
 	delete[] y;
 }
 
+//
+// Initial alphas of the nu-SVC for the samples with y[i] == sign, such that
+// their sum equals target and 0 <= alpha <= 1. Without a warm start, the
+// first alphas are set to 1 until the sum is reached. Otherwise, alpha is
+// set proportional to |alpha0| (where nonzero), clipping the largest values
+// at 1. If that does not suffice to reach the target, the remaining alphas
+// are filled in as in the former case.
+//
+static void init_nu_alpha(int l, const schar *y, schar sign,
+	const double *alpha0, double target, double *alpha)
+{
+	int i, n = 0;
+	int *idx = new int[l];
+	for(i=0;i<l;i++)
+		if(y[i] == sign)
+		{
+			alpha[i] = 0;
+			if(alpha0 && alpha0[i] != 0)
+				idx[n++] = i;
+		}
+
+	if(n > 0)
+	{
+		std::sort(idx, idx+n, [alpha0](int a, int b) {
+			return fabs(alpha0[a]) > fabs(alpha0[b]);
+		});
+		double S = 0;
+		for(int k=0;k<n;k++)
+			S += fabs(alpha0[idx[k]]);
+
+		// the m largest values are clipped at 1, the rest scaled by s
+		int m = 0;
+		double s = 0;
+		for(;m<n;m++)
+		{
+			s = (target-m)/S;
+			if(s*fabs(alpha0[idx[m]]) <= 1)
+				break;
+			S -= fabs(alpha0[idx[m]]);
+		}
+		for(int k=0;k<n;k++)
+			alpha[idx[k]] = k < m ? 1 : s*fabs(alpha0[idx[k]]);
+		if(m < n)
+			target = 0;
+		else
+			target -= n;
+	}
+
+	for(i=0;i<l && target > 0;i++)
+		if(y[i] == sign && alpha[i] == 0)
+		{
+			alpha[i] = min(1.0,target);
+			target -= alpha[i];
+		}
+
+	delete[] idx;
+}
+
 static void solve_nu_svc(
 	const svm_problem *prob, const svm_parameter *param,
-	double *alpha, Solver::SolutionInfo* si)
+	double *alpha, Solver::SolutionInfo* si, const pair_context *ctx)
 {
 	int i;
 	int l = prob->l;
@@ -1516,29 +2232,24 @@ static void solve_nu_svc(
 		else
 			y[i] = -1;
 
-	double sum_pos = nu*l/2;
-	double sum_neg = nu*l/2;
-
-	for(i=0;i<l;i++)
-		if(y[i] == +1)
-		{
-			alpha[i] = min(1.0,sum_pos);
-			sum_pos -= alpha[i];
-		}
-		else
-		{
-			alpha[i] = min(1.0,sum_neg);
-			sum_neg -= alpha[i];
-		}
+	init_nu_alpha(l,y,+1,ctx ? ctx->alpha : NULL,nu*l/2,alpha);
+	init_nu_alpha(l,y,-1,ctx ? ctx->alpha : NULL,nu*l/2,alpha);
 
 	double *zeros = new double[l];
 
 	for(i=0;i<l;i++)
 		zeros[i] = 0;
 
-	Solver_NU s;
-	s.Solve(l, SVC_Q(*prob,*param,y), zeros, y,
-		alpha, 1.0, 1.0, param->eps, si,  param->shrinking);
+	if(param->dual_cd)
+		solve_nu_dcd(l, prob->x, y, alpha, param, si);
+	else
+	{
+		QMatrix *Q = new_svc_q(prob,param,y,ctx);
+		Solver_NU s;
+		s.Solve(l, *Q, zeros, y,
+			alpha, 1.0, 1.0, param->eps, si,  param->shrinking);
+		delete Q;
+	}
 	double r = si->r;
 
 	info("C = %f\n",1/r);
@@ -1674,17 +2385,17 @@ struct decision_function
 
 static decision_function svm_train_one(
 	const svm_problem *prob, const svm_parameter *param,
-	double Cp, double Cn)
+	double Cp, double Cn, const pair_context *ctx = NULL)
 {
 	double *alpha = Malloc(double,prob->l);
 	Solver::SolutionInfo si;
 	switch(param->svm_type)
 	{
 		case C_SVC:
-			solve_c_svc(prob,param,alpha,&si,Cp,Cn);
+			solve_c_svc(prob,param,alpha,&si,Cp,Cn,ctx);
 			break;
 		case NU_SVC:
-			solve_nu_svc(prob,param,alpha,&si);
+			solve_nu_svc(prob,param,alpha,&si,ctx);
 			break;
 		case ONE_CLASS:
 			solve_one_class(prob,param,alpha,&si);
@@ -1917,10 +2628,14 @@ static void multiclass_probability(int k, double **r, double *p)
 	free(Qp);
 }
 
+static svm_model *svm_train_budget(const svm_problem *prob,
+	const svm_parameter *param, Cache_Budget *parent);
+
 // Cross-validation decision values for probability estimates
+// the folds draw their kernel caches from the budget of the calling pair
 static void svm_binary_svc_probability(
 	const svm_problem *prob, const svm_parameter *param,
-	double Cp, double Cn, double& probA, double& probB)
+	double Cp, double Cn, double& probA, double& probB, Cache_Budget *budget)
 {
 	int i;
 	int nr_fold = 5;
@@ -1978,6 +2693,9 @@ static void svm_binary_svc_probability(
 		{
 			svm_parameter subparam = *param;
 			subparam.probability=0;
+			subparam.gram=GRAM_NONE;	// would be recomputed for every fold
+			subparam.warm_start=NULL;	// trained on different samples
+			subparam.scheduler=NULL;	// only this process solves the pair
 			subparam.C=1.0;
 			subparam.nr_weight=2;
 			subparam.weight_label = Malloc(int,2);
@@ -1986,7 +2704,7 @@ static void svm_binary_svc_probability(
 			subparam.weight_label[1]=-1;
 			subparam.weight[0]=Cp;
 			subparam.weight[1]=Cn;
-			struct svm_model *submodel = svm_train(&subprob,&subparam);
+			struct svm_model *submodel = svm_train_budget(&subprob,&subparam,budget);
 			for(j=begin;j<end;j++)
 			{
 				svm_predict_values(submodel,prob->x[perm[j]],&(dec_values[perm[j]]));
@@ -2114,14 +2832,73 @@ static void svm_group_classes(const svm_problem *prob, int *nr_class_ret, int **
 	free(data_label);
 }
 
+//
+// Whether the model trained with parameters warm solves the same dual
+// problem as training with param does, given the same training data
+//
+// FNV-1a checksum of the labels and samples of the first l samples of prob,
+// to tell whether a warm-start model was trained on a prefix of prob
+static unsigned int checksum_prefix(const svm_problem *prob, int l)
+{
+	unsigned int h = 2166136261u;
+	auto add = [&h](const void *data, size_t n) {
+		const unsigned char *c = (const unsigned char *)data;
+		for(size_t k=0;k<n;k++)
+			h = (h ^ c[k]) * 16777619u;
+	};
+	for(int i=0;i<l;i++)
+	{
+		add(&prob->y[i],sizeof(double));
+		const svm_node *px = prob->x[i];
+		for(; px->index != -1; ++px)
+		{
+			add(&px->index,sizeof(int));
+			add(&px->value,sizeof(double));
+		}
+		add(&px->index,sizeof(int));
+	}
+	return h;
+}
+
+static bool same_objective(const svm_parameter *param, const svm_parameter *warm)
+{
+	if(param->svm_type != warm->svm_type || param->kernel_type != warm->kernel_type)
+		return false;
+	if(param->svm_type == NU_SVC && param->nu != warm->nu)
+		return false;
+	if(param->kernel_type == POLY && param->degree != warm->degree)
+		return false;
+	if((param->kernel_type == POLY || param->kernel_type == RBF || param->kernel_type == SIGMOID) &&
+	   param->gamma != warm->gamma)
+		return false;
+	if((param->kernel_type == POLY || param->kernel_type == SIGMOID) &&
+	   param->coef0 != warm->coef0)
+		return false;
+	return true;
+}
+
 //
 // Interface functions
 //
 svm_model *svm_train(const svm_problem *prob, const svm_parameter *param)
+{
+	return svm_train_budget(prob,param,NULL);
+}
+
+// if parent is non-NULL, the kernel caches are drawn from it rather than
+// from a budget of their own
+static svm_model *svm_train_budget(const svm_problem *prob,
+	const svm_parameter *param, Cache_Budget *parent)
 {
 	svm_model *model = Malloc(svm_model,1);
 	model->param = *param;
+	model->param.warm_start = NULL;
+	model->param.scheduler = NULL;
+	model->l_train = prob->l;
+	model->checksum_train = checksum_prefix(prob,prob->l);
 	model->free_sv = 0;	// XXX
+	model->cache_hits = 0;
+	model->cache_misses = 0;
 
 	if(param->svm_type == ONE_CLASS ||
 	   param->svm_type == EPSILON_SVR ||
@@ -2185,6 +2962,71 @@ svm_model *svm_train(const svm_problem *prob, const svm_parameter *param)
 		for(int i=0;i<l;i++)
 			x[i] = prob->x[perm[i]];
 
+		// cache_size is the total cache size of all pairs, split among
+		// those solved concurrently in proportion to their size
+
+		Cache_Budget own_budget((long int)(param->cache_size*(1<<20)));
+		Cache_Budget& budget = parent ? *parent : own_budget;
+
+		// precompute the Gram matrix shared by all pairs
+
+		float *gram_f = NULL;
+		double *gram_d = NULL;
+		if(!(param->svm_type == NU_SVC && param->dual_cd))
+		{
+			if(param->gram == GRAM_FLOAT)
+				gram_f = calculate_gram<float>(l,x,*param);
+			else if(param->gram == GRAM_DOUBLE)
+				gram_d = calculate_gram<double>(l,x,*param);
+		}
+
+		// map the classes to those of the model to warm-start from. If the
+		// training set extends the previous one (samples appended), pairs
+		// of classes which did not grow are taken over unchanged.
+
+		const svm_model *warm = param->svm_type == NU_SVC ? param->warm_start : NULL;
+		if(warm && warm->sv_indices == NULL)
+		{
+			info("WARNING: warm-start model has no SV indices, starting from scratch\n");
+			warm = NULL;
+		}
+		int *warm_class = NULL;
+		int *warm_nz_start = NULL;
+		int *inv_perm = NULL;
+		int *max_index = NULL;
+		bool reuse = false;
+		int nr_reused = 0;
+		if(warm)
+		{
+			reuse = warm->l_train > 0 && warm->l_train <= l &&
+				same_objective(param,&warm->param) &&
+				checksum_prefix(prob,warm->l_train) == warm->checksum_train;
+			if(!reuse)
+				info("Training set does not extend that of the warm-start model, no classifiers are reused\n");
+			warm_class = Malloc(int,nr_class);
+			for(int i=0;i<nr_class;i++)
+			{
+				warm_class[i] = -1;
+				for(int k=0;k<warm->nr_class;k++)
+					if(warm->label[k] == label[i])
+						warm_class[i] = k;
+			}
+			warm_nz_start = Malloc(int,warm->nr_class);
+			warm_nz_start[0] = 0;
+			for(int k=1;k<warm->nr_class;k++)
+				warm_nz_start[k] = warm_nz_start[k-1]+warm->nSV[k-1];
+			inv_perm = Malloc(int,l);
+			for(int i=0;i<l;i++)
+				inv_perm[perm[i]] = i;
+			max_index = Malloc(int,nr_class);
+			for(int i=0;i<nr_class;i++)
+			{
+				max_index[i] = -1;
+				for(int k=start[i];k<start[i]+count[i];k++)
+					max_index[i] = std::max(max_index[i],perm[k]);
+			}
+		}
+
 		// calculate weighted C
 
 		double *weighted_C = Malloc(double, nr_class);
@@ -2217,8 +3059,7 @@ svm_model *svm_train(const svm_problem *prob, const svm_parameter *param)
 			probB=Malloc(double,nr_trig);
 		}
 
-#pragma omp parallel for schedule(guided)
-		for (int p = 0; p < nr_trig; ++p) {
+		auto solve_pair = [&](int p) {
 			int i = nr_class - 0.5 * (1 + sqrt(8 * (nr_trig - p) + 1));
 			int j = p - (2 * nr_class - i - 3) * i / 2 + 1;
 
@@ -2228,30 +3069,183 @@ svm_model *svm_train(const svm_problem *prob, const svm_parameter *param)
 			sub_prob.l = ci+cj;
 			sub_prob.x = Malloc(svm_node *,sub_prob.l);
 			sub_prob.y = Malloc(double,sub_prob.l);
+			int *sub_index = Malloc(int,sub_prob.l);
 			int k;
 			for(k=0;k<ci;k++)
 			{
 				sub_prob.x[k] = x[si+k];
 				sub_prob.y[k] = +1;
+				sub_index[k] = si+k;
 			}
 			for(k=0;k<cj;k++)
 			{
 				sub_prob.x[ci+k] = x[sj+k];
 				sub_prob.y[ci+k] = -1;
+				sub_index[ci+k] = sj+k;
 			}
 
 			if(param->probability)
-				svm_binary_svc_probability(&sub_prob,param,weighted_C[i],weighted_C[j],probA[p],probB[p]);
+				svm_binary_svc_probability(&sub_prob,param,weighted_C[i],weighted_C[j],probA[p],probB[p],&budget);
 
-			f[p] = svm_train_one(&sub_prob,param,weighted_C[i],weighted_C[j]);
-			for(k=0;k<ci;k++)
-				if(!nonzero[si+k] && fabs(f[p].alpha[k]) > 0)
-					nonzero[si+k] = true;
-			for(k=0;k<cj;k++)
-				if(!nonzero[sj+k] && fabs(f[p].alpha[ci+k]) > 0)
-					nonzero[sj+k] = true;
+			double *alpha0 = NULL;
+			int wi = warm ? warm_class[i] : -1;
+			int wj = warm ? warm_class[j] : -1;
+			if(wi >= 0 && wj >= 0)
+			{
+				// coefficients of the SVs of both classes in the previous
+				// classifier between them, mapped onto the subproblem
+				alpha0 = Malloc(double,sub_prob.l);
+				for(k=0;k<sub_prob.l;k++)
+					alpha0[k] = 0;
+				const double *coef_i = warm->sv_coef[wi < wj ? wj-1 : wj];
+				const double *coef_j = warm->sv_coef[wj < wi ? wi-1 : wi];
+				for(int q=warm_nz_start[wi];q<warm_nz_start[wi]+warm->nSV[wi];q++)
+				{
+					int o = warm->sv_indices[q]-1;
+					if(o < l && inv_perm[o] >= si && inv_perm[o] < si+ci)
+						alpha0[inv_perm[o]-si] = coef_i[q];
+				}
+				for(int q=warm_nz_start[wj];q<warm_nz_start[wj]+warm->nSV[wj];q++)
+				{
+					int o = warm->sv_indices[q]-1;
+					if(o < l && inv_perm[o] >= sj && inv_perm[o] < sj+cj)
+						alpha0[ci+inv_perm[o]-sj] = coef_j[q];
+				}
+			}
+
+			if(alpha0 && reuse &&
+			   max_index[i] < warm->l_train && max_index[j] < warm->l_train)
+			{
+				// same samples in both classes: the previous solution is
+				// still optimal, up to the orientation of the classifier
+				int a = std::min(wi,wj), b = std::max(wi,wj);
+				int pw = (2 * warm->nr_class - a - 3) * a / 2 + b - 1;
+				double sign = wi < wj ? 1 : -1;
+				for(k=0;k<sub_prob.l;k++)
+					alpha0[k] *= sign;
+				f[p].alpha = alpha0;
+				f[p].rho = sign * warm->rho[pw];
+#pragma omp atomic
+				++nr_reused;
+			}
+			else
+			{
+				gram_view gram = { gram_f, gram_d, l, sub_index };
+				pair_context ctx = { (gram_f || gram_d) ? &gram : NULL, &budget, alpha0 };
+				f[p] = svm_train_one(&sub_prob,param,weighted_C[i],weighted_C[j],&ctx);
+				free(alpha0);
+			}
 			free(sub_prob.x);
 			free(sub_prob.y);
+			free(sub_index);
+		};
+
+		const svm_pair_scheduler *scheduler = param->scheduler;
+		if(scheduler == NULL)
+		{
+			// a single pair is parallelized within the solver instead
+#pragma omp parallel for schedule(guided) if(nr_trig > 1)
+			for (int p = 0; p < nr_trig; ++p)
+				solve_pair(p);
+		}
+		else
+		{
+			// the pairs are handed out largest first, so that the small
+			// ones fill the gaps at the end; all processes agree on the
+			// order as they hold the same problem
+			int *pair_l = Malloc(int,nr_trig);
+			int *order = Malloc(int,nr_trig);
+			bool *solved = Malloc(bool,nr_trig);
+			for(int i=0, p=0; i<nr_class; i++)
+				for(int j=i+1; j<nr_class; j++, p++)
+					pair_l[p] = count[i]+count[j];
+			for(int p=0;p<nr_trig;p++)
+			{
+				order[p] = p;
+				solved[p] = false;
+			}
+			std::stable_sort(order, order+nr_trig,
+				[pair_l](int a, int b) { return pair_l[a] > pair_l[b]; });
+
+#pragma omp parallel if(nr_trig > 1)
+			while(true)
+			{
+				int t;
+#pragma omp critical(svm_pair_scheduler)
+				t = scheduler->next(scheduler->context);
+				if(t < 0 || t >= nr_trig)
+					break;
+				solved[order[t]] = true;
+				solve_pair(order[t]);
+			}
+
+			// exchange the solutions: pair index, rho, [probA, probB,] alpha
+			int header = param->probability ? 4 : 2;
+			long int n = 0;
+			for(int p=0;p<nr_trig;p++)
+				if(solved[p])
+					n += header + pair_l[p];
+			double *local = Malloc(double,n);
+			double *it = local;
+			for(int p=0;p<nr_trig;p++)
+				if(solved[p])
+				{
+					*it++ = p;
+					*it++ = f[p].rho;
+					if(param->probability)
+					{
+						*it++ = probA[p];
+						*it++ = probB[p];
+					}
+					memcpy(it, f[p].alpha, sizeof(double)*pair_l[p]);
+					it += pair_l[p];
+					free(f[p].alpha);
+				}
+			long int total;
+			double *all = scheduler->gather(scheduler->context, local, n, &total);
+			free(local);
+			for(long int q=0; q<total;)
+			{
+				int p = (int)all[q];
+				f[p].rho = all[q+1];
+				if(param->probability)
+				{
+					probA[p] = all[q+2];
+					probB[p] = all[q+3];
+				}
+				q += header;
+				f[p].alpha = Malloc(double,pair_l[p]);
+				memcpy(f[p].alpha, all+q, sizeof(double)*pair_l[p]);
+				q += pair_l[p];
+			}
+			free(all);
+			free(pair_l);
+			free(order);
+			free(solved);
+		}
+
+		for (int p = 0; p < nr_trig; ++p) {
+			int i = nr_class - 0.5 * (1 + sqrt(8 * (nr_trig - p) + 1));
+			int j = p - (2 * nr_class - i - 3) * i / 2 + 1;
+			for(int k=0;k<count[i];k++)
+				if(fabs(f[p].alpha[k]) > 0)
+					nonzero[start[i]+k] = true;
+			for(int k=0;k<count[j];k++)
+				if(fabs(f[p].alpha[count[i]+k]) > 0)
+					nonzero[start[j]+k] = true;
+		}
+		free(gram_f);
+		free(gram_d);
+		free(warm_class);
+		free(warm_nz_start);
+		free(inv_perm);
+		free(max_index);
+		if(warm)
+			info("Reused %d of %d classifiers\n",nr_reused,nr_trig);
+		if(!parent)
+		{
+			model->cache_hits = budget.nr_hits();
+			model->cache_misses = budget.nr_misses();
 		}
 
 		// build output
@@ -2367,6 +3361,12 @@ void svm_cross_validation(const svm_problem *prob, const svm_parameter *param, i
 	int l = prob->l;
 	int *perm = Malloc(int,l);
 	int nr_class;
+	// the folds are trained on different samples than the warm-start model;
+	// each process trains all of them itself, as the folds are drawn with
+	// rand() and need not agree among processes
+	svm_parameter subparam = *param;
+	subparam.warm_start = NULL;
+	subparam.scheduler = NULL;
 	if (nr_fold > l)
 	{
 		nr_fold = l;
@@ -2460,7 +3460,7 @@ void svm_cross_validation(const svm_problem *prob, const svm_parameter *param, i
 			subprob.y[k] = prob->y[perm[j]];
 			++k;
 		}
-		struct svm_model *submodel = svm_train(&subprob,param);
+		struct svm_model *submodel = svm_train(&subprob,&subparam);
 		if(param->probability && 
 		   (param->svm_type == C_SVC || param->svm_type == NU_SVC))
 		{
@@ -2801,6 +3801,11 @@ bool read_model_header(FILE *fp, svm_model* model)
 	param.nr_weight = 0;
 	param.weight_label = NULL;
 	param.weight = NULL;
+	param.dual_cd = 0;
+	param.gram = GRAM_NONE;
+	param.warm_start = NULL;
+	param.scheduler = NULL;
+	param.nu = 0;
 
 	char cmd[81];
 	while(1)
@@ -2926,6 +3931,10 @@ svm_model *svm_load_model(const char *model_file_name)
 	model->probA = NULL;
 	model->probB = NULL;
 	model->sv_indices = NULL;
+	model->l_train = 0;
+	model->checksum_train = 0;
+	model->cache_hits = 0;
+	model->cache_misses = 0;
 	model->label = NULL;
 	model->nSV = NULL;
 	
@@ -3131,6 +4140,22 @@ const char *svm_check_parameter(const svm_problem *prob, const svm_parameter *pa
 	   svm_type == ONE_CLASS)
 		return "one-class SVM probability output not supported yet";
 
+	if(param->dual_cd != 0 &&
+	   param->dual_cd != 1)
+		return "dual_cd != 0 and dual_cd != 1";
+
+	if(param->warm_start != NULL && svm_type != NU_SVC)
+		return "warm start requires nu-SVC";
+
+	if(param->gram != GRAM_NONE &&
+	   param->gram != GRAM_FLOAT &&
+	   param->gram != GRAM_DOUBLE)
+		return "unknown Gram matrix precision";
+
+	if(param->dual_cd == 1 &&
+	   (svm_type != NU_SVC || kernel_type != LINEAR))
+		return "dual coordinate descent only supported for linear nu-SVC";
+
 
 	// check whether nu-svc is feasible
 	
@@ -0,0 +1,55 @@
+/*   Support Vector Machine Library Wrappers
+ *   Copyright (C) 2018-2019  Jonas Greitemann
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program, see the file entitled "LICENCE" in the
+ *   repository's root directory, or see <http://www.gnu.org/licenses/>.
+ */
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "doctest/doctest.h"
+#include "tile_problem.hpp"
+
+#include <iostream>
+
+#include <svm/kernel/rbf.hpp>
+#include <svm/model.hpp>
+#include <svm/parameters.hpp>
+#include <svm/problem.hpp>
+
+
+using kernel_t = svm::kernel::rbf;
+using model_t = svm::model<kernel_t>;
+
+TEST_CASE("cache-budget") {
+    // the cache size is a total budget; starving the caches must not change
+    // the result but only reduce the hit rate
+    svm::parameters<kernel_t> params_large(0.1), params_small(0.1);
+    params_small.cache_size() = 0.01;
+
+    model_t model_large(tile_problem<kernel_t>(2000), params_large);
+    model_t model_small(tile_problem<kernel_t>(2000), params_small);
+    std::cout << "hit rate (large): " << model_large.cache_hit_rate() << '\n'
+              << "hit rate (small): " << model_small.cache_hit_rate() << '\n';
+
+    CHECK(model_large.cache_hit_rate() > 0);
+    CHECK(model_large.cache_hit_rate() <= 1);
+    CHECK(model_small.cache_hit_rate() < model_large.cache_hit_rate());
+
+    auto rho_large = model_large.rho();
+    auto rho_small = model_small.rho();
+    CHECK(rho_large.size() == 36);
+    for (size_t i = 0; i < rho_large.size(); ++i)
+        CHECK(rho_small[i] == doctest::Approx(rho_large[i]).epsilon(1e-3));
+}
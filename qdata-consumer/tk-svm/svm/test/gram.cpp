@@ -0,0 +1,88 @@
+/*   Support Vector Machine Library Wrappers
+ *   Copyright (C) 2018-2019  Jonas Greitemann
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program, see the file entitled "LICENCE" in the
+ *   repository's root directory, or see <http://www.gnu.org/licenses/>.
+ */
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "doctest/doctest.h"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <svm/kernel/linear.hpp>
+#include <svm/kernel/polynomial.hpp>
+#include <svm/kernel/rbf.hpp>
+#include <svm/model.hpp>
+#include <svm/parameters.hpp>
+#include <svm/problem.hpp>
+
+
+// multiclassification of points in the unit square into four quadrants
+template <class Kernel, class RNG>
+svm::problem<Kernel> quadrant_problem (size_t M, RNG & rng) {
+    std::uniform_real_distribution<double> uniform(-1, 1);
+    svm::problem<Kernel> prob(2);
+    using input_t = typename svm::problem<Kernel>::input_container_type;
+    for (size_t m = 0; m < M; ++m) {
+        std::vector<double> xs {uniform(rng), uniform(rng)};
+        double label = (xs[0] > 0 ? 1 : 0) + (xs[1] > 0 ? 2 : 0);
+        prob.add_sample(input_t(std::move(xs)), label);
+    }
+    return prob;
+}
+
+template <class Kernel>
+void gram_test (svm::parameters<Kernel> params, svm::gram_precision prec) {
+    using model_t = svm::model<Kernel>;
+    std::mt19937 rng(42);
+    std::mt19937 rng_gram(rng);
+
+    model_t model(quadrant_problem<Kernel>(1000, rng), params);
+    params.gram(prec);
+    model_t model_gram(quadrant_problem<Kernel>(1000, rng_gram), params);
+
+    CHECK(model.nr_labels() == 4);
+    CHECK(model_gram.nr_labels() == 4);
+    auto rho = model.rho();
+    auto rho_gram = model_gram.rho();
+    auto it_gram = rho_gram.begin();
+    for (double r : rho) {
+        CHECK(*it_gram == doctest::Approx(r).epsilon(1e-3));
+        ++it_gram;
+    }
+}
+
+TEST_CASE("gram-linear-double") {
+    gram_test(svm::parameters<svm::kernel::linear>(0.1),
+              svm::gram_precision::DOUBLE);
+}
+
+TEST_CASE("gram-linear-float") {
+    gram_test(svm::parameters<svm::kernel::linear>(0.1),
+              svm::gram_precision::FLOAT);
+}
+
+TEST_CASE("gram-poly") {
+    gram_test(svm::parameters<svm::kernel::polynomial<2>>(0.1),
+              svm::gram_precision::DOUBLE);
+}
+
+TEST_CASE("gram-rbf") {
+    gram_test(svm::parameters<svm::kernel::rbf>(0.1),
+              svm::gram_precision::FLOAT);
+}
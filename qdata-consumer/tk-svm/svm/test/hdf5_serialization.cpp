@@ -30,14 +30,150 @@ TEST_CASE("model-serializer-hdf5-builtin") {
     model_serializer_test<svm::kernel::linear, svm::hdf5_tag>(4, 1000, 0.99, "hdf5-builtin-model.h5");
 }
 
+TEST_CASE("model-serializer-hdf5-builtin-support-vectors") {
+    model_serializer_test<svm::kernel::linear, svm::hdf5_tag>(4, 1000, 0.99, "hdf5-builtin-sv-model.h5", true);
+}
+
+TEST_CASE("model-serializer-hdf5-sparse-support-vectors") {
+    using kernel_t = svm::kernel::linear;
+    using input_t = typename svm::problem<kernel_t>::input_container_type;
+    const size_t dim = 20, M = 500;
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> uniform(-1., 1.);
+    std::bernoulli_distribution nonzero(0.2);
+    std::vector<std::vector<double>> samples;
+    svm::problem<kernel_t> prob(dim);
+    for (size_t m = 0; m < M; ++m) {
+        std::vector<double> xs(dim);
+        for (double & x : xs)
+            if (nonzero(rng))
+                x = uniform(rng);
+        samples.push_back(xs);
+        double y = xs[0] + xs[1] > 0 ? 1 : -1;
+        prob.add_sample(input_t(std::move(xs)), y);
+    }
+    svm::model<kernel_t> model(std::move(prob), svm::parameters<kernel_t> {});
+    svm::serialization::model_serializer<svm::hdf5_tag, svm::model<kernel_t>> saver(model, true);
+    saver.save("hdf5-sparse-sv-model.h5");
+
+    {
+        alps::hdf5::archive ar("hdf5-sparse-sv-model.h5", "r");
+        size_t l = ar.extent("SV/indptr")[0] - 1;
+        CHECK(ar.extent("SV/values")[0] < l * dim / 2);
+    }
+
+    svm::model<kernel_t> restored_model;
+    svm::serialization::model_serializer<svm::hdf5_tag, svm::model<kernel_t>> loader(restored_model);
+    loader.load("hdf5-sparse-sv-model.h5");
+    for (auto const& xs : samples) {
+        auto expected = model(input_t(xs));
+        auto restored = restored_model(input_t(xs));
+        CHECK(restored.first == expected.first);
+        CHECK(restored.second[0] == doctest::Approx(expected.second[0]));
+    }
+}
+
+TEST_CASE("model-serializer-hdf5-overwrite") {
+    // a model saved into an archive which already holds one of the other
+    // form replaces it entirely
+    using kernel_t = svm::kernel::linear;
+    using model_t = svm::model<kernel_t>;
+    using serializer_t = svm::serialization::model_serializer<svm::hdf5_tag, model_t>;
+    std::mt19937 rng(42);
+    hyperplane_model trial_model(4, rng);
+    model_t model_sv(fill_problem<svm::problem<kernel_t>>(1000, rng, trial_model),
+                     svm::parameters<kernel_t> {});
+    model_t model_w(fill_problem<svm::problem<kernel_t>>(500, rng, trial_model),
+                    svm::parameters<kernel_t> {});
+    REQUIRE(model_sv.classifier().rho() != model_w.classifier().rho());
+
+    alps::hdf5::archive ar("hdf5-overwrite-model.h5", "w");
+    {
+        serializer_t(model_sv, true).save(ar);
+        serializer_t(model_w).save(ar);
+        CHECK(!ar.is_data("sv_coef"));
+        CHECK(!ar.is_data("sv_indices"));
+        CHECK(!ar.is_group("SV"));
+        model_t restored;
+        serializer_t(restored).load(ar);
+        CHECK(restored.classifier().rho() == doctest::Approx(model_w.classifier().rho()));
+    }
+    {
+        serializer_t(model_sv, true).save(ar);
+        CHECK(!ar.is_data("W"));
+        model_t restored;
+        serializer_t(restored).load(ar);
+        CHECK(restored.classifier().rho() == doctest::Approx(model_sv.classifier().rho()));
+        CHECK(restored.svm_model_ptr()->sv_indices != nullptr);
+    }
+}
+
+TEST_CASE("model-serializer-hdf5-replace-sv") {
+    // the SVs of a model saved into an archive which already holds SVs in
+    // the other form, e.g. the dense dataset of earlier versions, replace
+    // the previous ones
+    using kernel_t = svm::kernel::linear;
+    using pre_kernel_t = svm::kernel::linear_precomputed;
+    std::mt19937 rng(42);
+    hyperplane_model trial_model(4, rng);
+    svm::model<kernel_t> model(fill_problem<svm::problem<kernel_t>>(500, rng, trial_model),
+                               svm::parameters<kernel_t> {});
+    svm::model<pre_kernel_t> pre_model(fill_problem<svm::problem<pre_kernel_t>>(500, rng, trial_model),
+                                       svm::parameters<pre_kernel_t> {});
+
+    alps::hdf5::archive ar("hdf5-replace-sv-model.h5", "w");
+    ar["SV"] << boost::multi_array<double, 2>(boost::extents[10][4]);
+    svm::serialization::model_serializer<svm::hdf5_tag, svm::model<kernel_t>>(model, true).save(ar);
+    CHECK(!ar.is_data("SV"));
+    CHECK(ar.is_group("SV"));
+    {
+        svm::model<kernel_t> restored;
+        svm::serialization::model_serializer<svm::hdf5_tag, svm::model<kernel_t>>(restored).load(ar);
+        CHECK(restored.classifier().rho() == doctest::Approx(model.classifier().rho()));
+    }
+
+    svm::serialization::model_serializer<svm::hdf5_tag, svm::model<pre_kernel_t>>(pre_model).save(ar);
+    CHECK(!ar.is_group("SV"));
+    CHECK(ar.is_data("SV"));
+    {
+        svm::model<pre_kernel_t> restored;
+        svm::serialization::model_serializer<svm::hdf5_tag, svm::model<pre_kernel_t>>(restored).load(ar);
+        CHECK(restored.classifier().rho() == doctest::Approx(pre_model.classifier().rho()));
+    }
+}
+
 TEST_CASE("model-serializer-hdf5-precomputed") {
     model_serializer_test<svm::kernel::linear_precomputed, svm::hdf5_tag>(4, 1000, 0.99, "hdf5-precomputed-model.h5");
 }
 
+TEST_CASE("model-summary-hdf5") {
+    using kernel_t = svm::kernel::linear;
+    std::mt19937 rng(42);
+    hyperplane_model trial_model(4, rng);
+    svm::model<kernel_t> model(
+        fill_problem<svm::problem<kernel_t>>(1000, rng, trial_model),
+        svm::parameters<kernel_t> {});
+    svm::serialization::model_serializer<svm::hdf5_tag, svm::model<kernel_t>> saver(model);
+    saver.save("hdf5-summary-model.h5");
+
+    svm::model_summary<double> summary;
+    svm::serialization::model_serializer<svm::hdf5_tag, svm::model_summary<double>> loader(summary);
+    loader.load("hdf5-summary-model.h5");
+    CHECK(summary.labels() == model.labels());
+    CHECK(summary.classifiers()[0].rho() == model.classifier().rho());
+    CHECK(summary.nSV().size() == 2);
+}
+
 TEST_CASE("problem-serializer-hdf5-builtin") {
     problem_serializer_test<svm::kernel::linear, svm::hdf5_tag>(4, 1000, "hdf5-builtin-problem.h5");
 }
 
+TEST_CASE("problem-serializer-hdf5-blocks") {
+    // more rows than fit into one block of the streamed save and load, and
+    // not a multiple of the block size
+    problem_serializer_test<svm::kernel::linear, svm::hdf5_tag>(2048, 1200, "hdf5-blocks-problem.h5");
+}
+
 TEST_CASE("problem-serializer-hdf5-precomputed") {
     problem_serializer_test<svm::kernel::linear_precomputed, svm::hdf5_tag>(4, 1000, "hdf5-precomputed-problem.h5");
 }
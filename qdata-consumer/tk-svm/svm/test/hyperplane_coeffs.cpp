@@ -92,3 +92,32 @@ TEST_CASE("hyperplane-coeffs-builtin") {
 TEST_CASE("hyperplane-coeffs-precomputed") {
     hyperplane_coeffs_test<svm::kernel::linear_precomputed>(4, 5000, 0.1);
 }
+
+// classification of points in the unit square into 3x3 tiles
+TEST_CASE("linear-coefficients-all-transitions") {
+    using model_t = svm::model<svm::kernel::linear>;
+    using input_t = model_t::input_container_type;
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> uniform(0, 1);
+    svm::problem<svm::kernel::linear> prob(2);
+    for (size_t m = 0; m < 1000; ++m) {
+        std::vector<double> xs {uniform(rng), uniform(rng)};
+        double label = int(3 * xs[0]) + 3 * int(3 * xs[1]);
+        prob.add_sample(input_t(std::move(xs)), label);
+    }
+    model_t model(std::move(prob), svm::parameters<svm::kernel::linear>());
+
+    // all transitions plus one of both orientations
+    auto cls = model.classifiers();
+    std::vector<model_t::classifier_type> transitions(cls.rbegin(), cls.rend());
+    transitions.push_back(model.classifier(5., 2.));
+    transitions.push_back(model.classifier(2., 5.));
+    std::vector<double> W = svm::linear_coefficients(model, transitions);
+    CHECK(W.size() == transitions.size() * model.dim());
+    for (size_t t = 0; t < transitions.size(); ++t) {
+        auto introspector = svm::linear_introspect(transitions[t]);
+        for (size_t i = 0; i < model.dim(); ++i)
+            CHECK(W[t * model.dim() + i]
+                  == doctest::Approx(introspector.coefficient(i)).epsilon(1e-12));
+    }
+}
@@ -0,0 +1,89 @@
+/*   Support Vector Machine Library Wrappers
+ *   Copyright (C) 2018-2019  Jonas Greitemann
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program, see the file entitled "LICENCE" in the
+ *   repository's root directory, or see <http://www.gnu.org/licenses/>.
+ */
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "doctest/doctest.h"
+#include "hyperplane_model.hpp"
+#include "model_test.hpp"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <svm/kernel/linear.hpp>
+#include <svm/model.hpp>
+#include <svm/parameters.hpp>
+#include <svm/problem.hpp>
+
+
+using kernel_t = svm::kernel::linear;
+using model_t = svm::model<kernel_t>;
+using problem_t = svm::problem<kernel_t>;
+
+TEST_CASE("hyperplane-dcd") {
+    std::mt19937 rng(42);
+    hyperplane_model trial_model(25, rng);
+
+    svm::parameters<kernel_t> params(0.1);
+    params.dual_coordinate_descent() = true;
+    model_t empirical_model(fill_problem<problem_t>(2500, rng, trial_model),
+                            params);
+    CHECK(empirical_model.nr_labels() == 2);
+
+    double success_rate = test_model(2500, rng, trial_model, empirical_model);
+    std::cout << "success rate: " << 100. * success_rate << "%\n";
+    CHECK(success_rate > 0.98);
+}
+
+TEST_CASE("hyperplane-dcd-vs-smo") {
+    // both solvers optimize the same dual, so the resulting hyperplanes
+    // should agree up to the tolerance of the stopping criterion; the bias
+    // is only determined up to an interval if one class has no free SVs
+    size_t N = 4;
+    std::mt19937 rng(42);
+    hyperplane_model trial_model(N, rng);
+    std::mt19937 rng_smo(rng), rng_dcd(rng);
+
+    svm::parameters<kernel_t> params_smo(0.1), params_dcd(0.1);
+    params_smo.svm_params_ptr()->eps = 1e-6;
+    params_dcd.svm_params_ptr()->eps = 1e-6;
+    params_dcd.dual_coordinate_descent() = true;
+    model_t model_smo(fill_problem<problem_t>(5000, rng_smo, trial_model),
+                      params_smo);
+    model_t model_dcd(fill_problem<problem_t>(5000, rng_dcd, trial_model),
+                      params_dcd);
+
+    auto intro_smo = linear_introspect(model_smo.classifier(1., -1.));
+    auto intro_dcd = linear_introspect(model_dcd.classifier(1., -1.));
+    std::vector<double> C_smo(N), C_dcd(N);
+    double norm_smo = 0, norm_dcd = 0;
+    for (size_t i = 0; i < N; ++i) {
+        C_smo[i] = intro_smo.coefficient(i);
+        C_dcd[i] = intro_dcd.coefficient(i);
+        norm_smo += C_smo[i] * C_smo[i];
+        norm_dcd += C_dcd[i] * C_dcd[i];
+    }
+    for (size_t i = 0; i < N; ++i)
+        CHECK(C_dcd[i] / sqrt(norm_dcd)
+              == doctest::Approx(C_smo[i] / sqrt(norm_smo)).epsilon(1e-4));
+
+    double agreement = test_model(5000, rng, model_smo, model_dcd);
+    std::cout << "agreement: " << 100. * agreement << "%\n";
+    CHECK(agreement > 0.99);
+}
@@ -0,0 +1,89 @@
+/*   Support Vector Machine Library Wrappers
+ *   Copyright (C) 2018-2019  Jonas Greitemann
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program, see the file entitled "LICENCE" in the
+ *   repository's root directory, or see <http://www.gnu.org/licenses/>.
+ */
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "doctest/doctest.h"
+#include "tile_problem.hpp"
+
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include <svm/dataset.hpp>
+#include <svm/detail/linear_weights.hpp>
+#include <svm/kernel/linear.hpp>
+#include <svm/libsvm/svm.h>
+#include <svm/parameters.hpp>
+#include <svm/problem.hpp>
+
+
+const size_t dim = 4;
+
+// the model reconstructed from its weight vectors has the same decision
+// functions as the original one
+void compact_test (size_t nx, size_t ny) {
+    std::mt19937 rng(42);
+    auto prob = tile_problem<svm::kernel::linear>(500, rng, dim, nx, ny);
+    svm::parameters<svm::kernel::linear> params;
+    struct svm_problem svm_prob = prob.generate();
+    struct svm_model * m = svm_train(&svm_prob, params.svm_params_ptr());
+
+    size_t nr_class = m->nr_class;
+    size_t nrc = nr_class * (nr_class - 1) / 2;
+    CHECK(nr_class == nx * ny);
+    std::vector<double> W(nrc * dim);
+    svm::detail::linear_weights(m, dim, W.data());
+
+    struct svm_model * mc = (struct svm_model *)malloc(sizeof(struct svm_model));
+    mc->param = m->param;
+    mc->nr_class = nr_class;
+    mc->label = (int *)malloc(sizeof(int) * nr_class);
+    std::copy(m->label, m->label + nr_class, mc->label);
+    mc->rho = (double *)malloc(sizeof(double) * nrc);
+    std::copy(m->rho, m->rho + nrc, mc->rho);
+    mc->probA = nullptr;
+    mc->probB = nullptr;
+    svm::detail::linear_model_from_weights(mc, dim, W.data());
+    CHECK(mc->l == int(nrc));
+
+    std::uniform_real_distribution<double> uniform(0, 1);
+    std::vector<double> dec(nrc), dec_compact(nrc);
+    for (size_t n = 0; n < 1000; ++n) {
+        std::vector<double> xs(dim);
+        for (double & x : xs)
+            x = uniform(rng);
+        svm::dataset ds(xs);
+        double label = svm_predict_values(m, ds.ptr(), dec.data());
+        double label_compact = svm_predict_values(mc, ds.ptr(), dec_compact.data());
+        CHECK(label == label_compact);
+        for (size_t c = 0; c < nrc; ++c)
+            CHECK(dec[c] == doctest::Approx(dec_compact[c]).epsilon(1e-10));
+    }
+
+    svm_free_and_destroy_model(&mc);
+    svm_free_and_destroy_model(&m);
+}
+
+TEST_CASE("linear-weights-binary") {
+    compact_test(2, 1);
+}
+
+TEST_CASE("linear-weights-multiclass") {
+    compact_test(3, 3);
+}
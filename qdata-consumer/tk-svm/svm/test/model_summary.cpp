@@ -0,0 +1,73 @@
+/*   Support Vector Machine Library Wrappers
+ *   Copyright (C) 2018-2019  Jonas Greitemann
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program, see the file entitled "LICENCE" in the
+ *   repository's root directory, or see <http://www.gnu.org/licenses/>.
+ */
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "doctest/doctest.h"
+
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <svm/kernel/linear.hpp>
+#include <svm/model.hpp>
+#include <svm/model_summary.hpp>
+#include <svm/parameters.hpp>
+#include <svm/problem.hpp>
+
+
+TEST_CASE("model-summary-classifiers") {
+    using kernel_t = svm::kernel::linear;
+    using model_t = svm::model<kernel_t>;
+    using input_t = model_t::input_container_type;
+
+    // labels appear in an order different from their sorted one
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> uniform(0, 1);
+    svm::problem<kernel_t> prob(2);
+    for (size_t m = 0; m < 1000; ++m) {
+        std::vector<double> xs {uniform(rng), uniform(rng)};
+        double label = (5 * (int(2 * xs[0]) + 2 * int(2 * xs[1]))) % 7;
+        prob.add_sample(input_t(std::move(xs)), label);
+    }
+    model_t model(std::move(prob), svm::parameters<kernel_t> {});
+    svm::model_summary<double> summary(model);
+
+    CHECK(summary.nr_labels() == model.nr_labels());
+    CHECK(summary.nr_classifiers() == model.nr_classifiers());
+    CHECK(summary.labels() == model.labels());
+
+    auto cls = model.classifiers();
+    auto sum_cls = summary.classifiers();
+    REQUIRE(sum_cls.size() == cls.size());
+    for (size_t c = 0; c < cls.size(); ++c) {
+        CHECK(sum_cls[c].labels() == cls[c].labels());
+        CHECK(sum_cls[c].rho() == cls[c].rho());
+    }
+
+    auto nSV = summary.nSV();
+    REQUIRE(nSV.size() == model.nr_labels());
+    size_t total = 0;
+    for (size_t k = 0; k < nSV.size(); ++k) {
+        auto label = model.labels()[k];
+        for (size_t c = 0; c < cls.size(); ++c)
+            if (cls[c].labels().first == label || cls[c].labels().second == label)
+                CHECK(nSV[k] > 0);
+        total += nSV[k];
+    }
+    CHECK(total == size_t(model.svm_model_ptr()->l));
+}
@@ -0,0 +1,165 @@
+/*   Support Vector Machine Library Wrappers
+ *   Copyright (C) 2018-2019  Jonas Greitemann
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program, see the file entitled "LICENCE" in the
+ *   repository's root directory, or see <http://www.gnu.org/licenses/>.
+ */
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "doctest/doctest.h"
+#include "tile_problem.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <algorithm>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <svm/kernel/rbf.hpp>
+#include <svm/model.hpp>
+#include <svm/parameters.hpp>
+#include <svm/problem.hpp>
+
+
+using kernel_t = svm::kernel::rbf;
+using model_t = svm::model<kernel_t>;
+
+// stands in for a group of processes, each of which trains on its own copy
+// of the problem in a separate thread
+struct process_group {
+    process_group (size_t n) : buffers(n), schedulers(n), contexts(n) {
+        for (size_t r = 0; r < n; ++r) {
+            contexts[r] = {this, r};
+            schedulers[r] = {&contexts[r], &next, &gather};
+        }
+    }
+
+    struct svm_pair_scheduler const* scheduler (size_t rank) const {
+        return &schedulers[rank];
+    }
+
+private:
+    struct context {
+        process_group * group;
+        size_t rank;
+    };
+
+    static int next (void * ctx) {
+        return static_cast<context *>(ctx)->group->counter++;
+    }
+
+    static double * gather (void * ctx, const double * local, long int n,
+                            long int * total)
+    {
+        auto & self = *static_cast<context *>(ctx);
+        auto & group = *self.group;
+        std::unique_lock<std::mutex> lock(group.mutex);
+        group.buffers[self.rank].assign(local, local + n);
+        if (++group.arrived == group.buffers.size())
+            group.cv.notify_all();
+        else
+            group.cv.wait(lock, [&] {
+                return group.arrived == group.buffers.size();
+            });
+
+        *total = 0;
+        for (auto const& b : group.buffers)
+            *total += b.size();
+        double * all = static_cast<double *>(malloc(sizeof(double) * *total));
+        double * it = all;
+        for (auto const& b : group.buffers)
+            it = std::copy(b.begin(), b.end(), it);
+        return all;
+    }
+
+    std::atomic<int> counter {0};
+    std::mutex mutex;
+    std::condition_variable cv;
+    size_t arrived = 0;
+    std::vector<std::vector<double>> buffers;
+    std::vector<struct svm_pair_scheduler> schedulers;
+    std::vector<context> contexts;
+};
+
+void check_same_model (model_t const& a, model_t const& b) {
+    struct svm_model const& ma = *a.svm_model_ptr();
+    struct svm_model const& mb = *b.svm_model_ptr();
+    REQUIRE(ma.nr_class == mb.nr_class);
+    REQUIRE(ma.l == mb.l);
+    int k = ma.nr_class;
+    for (int i = 0; i < k; ++i) {
+        CHECK(ma.label[i] == mb.label[i]);
+        CHECK(ma.nSV[i] == mb.nSV[i]);
+    }
+    for (int p = 0; p < k * (k - 1) / 2; ++p)
+        CHECK(ma.rho[p] == mb.rho[p]);
+    for (int c = 0; c < k - 1; ++c)
+        for (int i = 0; i < ma.l; ++i)
+            CHECK(ma.sv_coef[c][i] == mb.sv_coef[c][i]);
+    for (int i = 0; i < ma.l; ++i)
+        CHECK(ma.sv_indices[i] == mb.sv_indices[i]);
+}
+
+void scheduled_training_test (size_t n_processes, bool probability = false) {
+    svm::parameters<kernel_t> params(0.2, svm::machine_type::NU_SVC);
+    params.svm_params_ptr()->probability = probability;
+    model_t reference(tile_problem<kernel_t>(1000), params);
+
+    process_group group(n_processes);
+    std::vector<model_t> models(n_processes);
+    std::vector<std::thread> threads;
+    for (size_t r = 0; r < n_processes; ++r)
+        threads.emplace_back([&, r] {
+            svm::parameters<kernel_t> p(params);
+            p.scheduler(group.scheduler(r));
+            models[r] = model_t(tile_problem<kernel_t>(1000), p);
+        });
+    for (auto & t : threads)
+        t.join();
+
+    for (auto const& m : models)
+        check_same_model(reference, m);
+
+    // the probability estimates depend on the random folds and differ from
+    // the reference, but each pair's are taken from the process solving it
+    if (probability) {
+        int nr_trig = 9 * 8 / 2;
+        for (auto const& m : models) {
+            REQUIRE(m.svm_model_ptr()->probA != nullptr);
+            REQUIRE(m.svm_model_ptr()->probB != nullptr);
+            for (int p = 0; p < nr_trig; ++p) {
+                CHECK(m.svm_model_ptr()->probA[p]
+                      == models[0].svm_model_ptr()->probA[p]);
+                CHECK(m.svm_model_ptr()->probB[p]
+                      == models[0].svm_model_ptr()->probB[p]);
+            }
+        }
+    }
+}
+
+TEST_CASE("pair-scheduler-single-process") {
+    scheduled_training_test(1);
+}
+
+TEST_CASE("pair-scheduler-multiple-processes") {
+    scheduled_training_test(3);
+}
+
+TEST_CASE("pair-scheduler-probability") {
+    scheduled_training_test(3, true);
+}
@@ -0,0 +1,93 @@
+/*   Support Vector Machine Library Wrappers
+ *   Copyright (C) 2018-2019  Jonas Greitemann
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program, see the file entitled "LICENCE" in the
+ *   repository's root directory, or see <http://www.gnu.org/licenses/>.
+ */
+
+// This test is built with the solver sources and a lowered PARALLEL_MIN_L
+// (see CMakeLists.txt), such that the loops of a single binary problem run
+// in parallel at a moderate size.
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "doctest/doctest.h"
+
+#include <random>
+#include <vector>
+
+#include <omp.h>
+
+#include <svm/kernel/rbf.hpp>
+#include <svm/model.hpp>
+#include <svm/parameters.hpp>
+#include <svm/problem.hpp>
+
+
+using kernel_t = svm::kernel::rbf;
+using model_t = svm::model<kernel_t>;
+using problem_t = svm::problem<kernel_t>;
+
+// points in [-1,1]^2 labeled by a noisy circle; with a narrow kernel, most of
+// them end up as free support vectors, such that the gradient is
+// reconstructed from the free variables when unshrinking
+problem_t circle_problem (size_t M) {
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> uniform(-1, 1);
+    problem_t prob(2);
+    for (size_t m = 0; m < M; ++m) {
+        std::vector<double> xs {uniform(rng), uniform(rng)};
+        double r2 = xs[0] * xs[0] + xs[1] * xs[1] + 0.2 * uniform(rng);
+        prob.add_sample(problem_t::input_container_type(std::move(xs)),
+                        r2 < 0.5 ? 1 : -1);
+    }
+    return prob;
+}
+
+model_t train (svm::parameters<kernel_t> const& params, int n_threads) {
+    int n_threads_before = omp_get_max_threads();
+    omp_set_num_threads(n_threads);
+    model_t model(circle_problem(4000), params);
+    omp_set_num_threads(n_threads_before);
+    return model;
+}
+
+// the solution must be bitwise identical regardless of the number of threads
+void thread_count_test (svm::parameters<kernel_t> const& params) {
+    model_t serial = train(params, 1);
+    model_t parallel = train(params, 3);
+
+    struct svm_model const& ms = *serial.svm_model_ptr();
+    struct svm_model const& mp = *parallel.svm_model_ptr();
+    REQUIRE(ms.l == mp.l);
+    CHECK(ms.rho[0] == mp.rho[0]);
+    bool same_coefs = true;
+    for (int i = 0; i < ms.l; ++i) {
+        same_coefs &= (ms.sv_coef[0][i] == mp.sv_coef[0][i]);
+        same_coefs &= (ms.sv_indices[i] == mp.sv_indices[i]);
+    }
+    CHECK(same_coefs);
+}
+
+TEST_CASE("parallel-solver-nu-svc") {
+    svm::parameters<kernel_t> params(0.3, svm::machine_type::NU_SVC);
+    params.gamma() = 500;
+    thread_count_test(params);
+}
+
+TEST_CASE("parallel-solver-c-svc") {
+    svm::parameters<kernel_t> params(10., svm::machine_type::C_SVC);
+    params.gamma() = 500;
+    thread_count_test(params);
+}
@@ -22,8 +22,10 @@
 
 #include <array>
 #include <iostream>
+#include <random>
 #include <tuple>
 #include <utility>
+#include <vector>
 
 #include <svm/dataset.hpp>
 #include <svm/model.hpp>
@@ -110,3 +112,48 @@ TEST_CASE("polynomial-introspect-matrix") {
         for (size_t j = 0; j < 4; ++j)
             CHECK(u[i][j] == doctest::Approx(introspector.tensor({i, j})));
 }
+
+template <size_t D>
+svm::model<svm::kernel::polynomial<D>> random_poly_model (size_t dim, size_t M) {
+    using kernel_t = svm::kernel::polynomial<D>;
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> uniform(-1, 1);
+    svm::problem<kernel_t> prob(dim);
+    for (size_t n = 0; n < M; ++n) {
+        std::vector<double> x(dim);
+        for (double & xi : x)
+            xi = uniform(rng);
+        double y = x[0] * x[1] - x[dim-1] * x[dim-1] + 0.2;
+        prob.add_sample(svm::dataset(x), y > 0 ? 1. : -1.);
+    }
+    svm::parameters<kernel_t> params;
+    params.gamma() = 0.5;
+    params.coef0() = 1;
+    return {std::move(prob), params};
+}
+
+template <size_t K, class Classifier>
+void check_full_tensor (Classifier const& cl, size_t dim) {
+    auto introspector = svm::tensor_introspect<K>(cl);
+    std::vector<double> full = introspector.full_tensor(dim);
+    REQUIRE(full.size() == combinatorics::ipow(dim, K));
+    std::array<size_t, K> ind {};
+    for (double c : full) {
+        CHECK(c == doctest::Approx(introspector.tensor(ind)));
+        for (size_t q = K; q > 0 && ++ind[q-1] == dim; --q)
+            ind[q-1] = 0;
+    }
+}
+
+TEST_CASE("polynomial-introspect-full-tensor") {
+    check_full_tensor<1>(model.classifier(), 4);
+    check_full_tensor<2>(model.classifier(), 4);
+
+    auto model2 = random_poly_model<2>(70, 1000);
+    check_full_tensor<1>(model2.classifier(), 70);
+    check_full_tensor<2>(model2.classifier(), 70);
+
+    auto model3 = random_poly_model<3>(9, 1000);
+    check_full_tensor<2>(model3.classifier(), 9);
+    check_full_tensor<3>(model3.classifier(), 9);
+}
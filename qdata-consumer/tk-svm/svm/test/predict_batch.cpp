@@ -0,0 +1,95 @@
+/*   Support Vector Machine Library Wrappers
+ *   Copyright (C) 2018-2019  Jonas Greitemann
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program, see the file entitled "LICENCE" in the
+ *   repository's root directory, or see <http://www.gnu.org/licenses/>.
+ */
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "doctest/doctest.h"
+#include "tile_problem.hpp"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <svm/kernel/linear.hpp>
+#include <svm/kernel/polynomial.hpp>
+#include <svm/kernel/rbf.hpp>
+#include <svm/kernel/sigmoid.hpp>
+#include <svm/model.hpp>
+#include <svm/parameters.hpp>
+#include <svm/problem.hpp>
+
+
+const size_t dim = 5;
+
+template <class Kernel>
+void predict_batch_test (svm::parameters<Kernel> params, size_t nr_tiles,
+                         bool sparse = false) {
+    using model_t = svm::model<Kernel>;
+    using input_t = typename model_t::input_container_type;
+    std::mt19937 rng(42);
+    model_t model(tile_problem<Kernel>(500, rng, dim, nr_tiles, nr_tiles, sparse), params);
+
+    // not a multiple of the block size
+    size_t N = 1000;
+    std::uniform_real_distribution<double> uniform(0, 1);
+    std::vector<double> X(N * dim);
+    for (double & x : X)
+        x = uniform(rng);
+
+    size_t nrc = model.nr_classifiers();
+    std::vector<double> labels(N), decisions(N * nrc);
+    // a single block first, such that the workspace has to grow
+    for (size_t n_batch : {size_t(10), N, N}) {
+        model.predict_batch(X.data(), n_batch, labels.data(), decisions.data());
+        for (size_t n = 0; n < n_batch; ++n) {
+            auto res = model(input_t(X.begin() + n * dim, X.begin() + (n + 1) * dim));
+            CHECK(res.first == labels[n]);
+            for (size_t c = 0; c < nrc; ++c)
+                CHECK(res.second[c] == doctest::Approx(decisions[n * nrc + c]).epsilon(1e-10));
+        }
+    }
+}
+
+TEST_CASE("predict-batch-linear") {
+    predict_batch_test(svm::parameters<svm::kernel::linear>(), 2);
+    predict_batch_test(svm::parameters<svm::kernel::linear>(), 3);
+}
+
+TEST_CASE("predict-batch-poly") {
+    svm::parameters<svm::kernel::polynomial<2>> params;
+    params.coef0() = 1;
+    predict_batch_test(params, 2);
+    predict_batch_test(params, 3);
+}
+
+TEST_CASE("predict-batch-rbf") {
+    predict_batch_test(svm::parameters<svm::kernel::rbf>(), 2);
+    predict_batch_test(svm::parameters<svm::kernel::rbf>(), 3);
+}
+
+TEST_CASE("predict-batch-sparse") {
+    predict_batch_test(svm::parameters<svm::kernel::linear>(), 3, true);
+    predict_batch_test(svm::parameters<svm::kernel::rbf>(), 3, true);
+}
+
+TEST_CASE("predict-batch-sigmoid") {
+    svm::parameters<svm::kernel::sigmoid> params;
+    params.gamma() = 0.1;
+    predict_batch_test(params, 2);
+    predict_batch_test(params, 3);
+}
@@ -34,8 +34,9 @@
 #include <svm/serialization/serializer.hpp>
 
 
-template <class Kernel, class Tag>
-void model_serializer_test (size_t N, size_t M, double threshold, std::string const& name) {
+template <class Kernel, class Tag, typename... SerializerArgs>
+void model_serializer_test (size_t N, size_t M, double threshold, std::string const& name,
+                            SerializerArgs... serializer_args) {
     std::mt19937 rng(42);
 
     hyperplane_model trial_model(N, rng);
@@ -44,7 +45,8 @@ void model_serializer_test (size_t N, size_t M, double threshold, std::string co
         fill_problem<svm::problem<Kernel>>(M, rng, trial_model),
         params);
 
-    svm::serialization::model_serializer<Tag, svm::model<Kernel>> saver(empirical_model);
+    svm::serialization::model_serializer<Tag, svm::model<Kernel>> saver(empirical_model,
+                                                                        serializer_args...);
     saver.save(name);
 
     svm::model<Kernel> restored_model;
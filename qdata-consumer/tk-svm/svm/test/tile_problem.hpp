@@ -0,0 +1,53 @@
+/*   Support Vector Machine Library Wrappers
+ *   Copyright (C) 2018-2019  Jonas Greitemann
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program, see the file entitled "LICENCE" in the
+ *   repository's root directory, or see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <svm/problem.hpp>
+
+
+// multiclassification of points in the unit hypercube into nx * ny tiles
+// spanned by the first two coordinates; the others are noise, or zero such
+// that the samples are sparse
+template <class Kernel, class RNG>
+svm::problem<Kernel> tile_problem (size_t M, RNG & rng, size_t dim = 2,
+                                   size_t nx = 3, size_t ny = 3,
+                                   bool sparse = false) {
+    std::uniform_real_distribution<double> uniform(0, 1);
+    svm::problem<Kernel> prob(dim);
+    using input_t = typename svm::problem<Kernel>::input_container_type;
+    for (size_t m = 0; m < M; ++m) {
+        std::vector<double> xs(dim);
+        for (size_t d = 0; d < (sparse ? 2 : dim); ++d)
+            xs[d] = uniform(rng);
+        double label = int(nx * xs[0]) + nx * int(ny * xs[1]);
+        prob.add_sample(input_t(std::move(xs)), label);
+    }
+    return prob;
+}
+
+// points in the unit square in 3x3 tiles, the same ones for a given M
+template <class Kernel>
+svm::problem<Kernel> tile_problem (size_t M) {
+    std::mt19937 rng(42);
+    return tile_problem<Kernel>(M, rng);
+}
@@ -0,0 +1,150 @@
+/*   Support Vector Machine Library Wrappers
+ *   Copyright (C) 2018-2019  Jonas Greitemann
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program, see the file entitled "LICENCE" in the
+ *   repository's root directory, or see <http://www.gnu.org/licenses/>.
+ */
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "doctest/doctest.h"
+#include "tile_problem.hpp"
+
+#include <cstdlib>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <svm/kernel/linear.hpp>
+#include <svm/kernel/rbf.hpp>
+#include <svm/libsvm/svm.h>
+#include <svm/model.hpp>
+#include <svm/parameters.hpp>
+#include <svm/problem.hpp>
+
+
+// the same problem, extended by N samples in the tiles 0 and 1 only
+template <class Kernel>
+svm::problem<Kernel> extended_tile_problem (size_t M, size_t N) {
+    svm::problem<Kernel> prob = tile_problem<Kernel>(M);
+    std::mt19937 rng(43);
+    std::uniform_real_distribution<double> uniform(0, 1);
+    using input_t = typename svm::problem<Kernel>::input_container_type;
+    for (size_t n = 0; n < N; ++n) {
+        std::vector<double> xs {2. / 3 * uniform(rng), 1. / 3 * uniform(rng)};
+        double label = int(3 * xs[0]);
+        prob.add_sample(input_t(std::move(xs)), label);
+    }
+    return prob;
+}
+
+// both models optimize the same dual problem, so their predictions should
+// agree up to the tolerance of the stopping criterion; the biases cannot be
+// compared directly as they are only determined up to an interval if one of
+// the classes has no free SVs
+template <class Model>
+void check_same_predictions (Model const& a, Model const& b) {
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<double> uniform(0, 1);
+    using input_t = typename Model::input_container_type;
+    size_t M = 1000, agree = 0;
+    for (size_t m = 0; m < M; ++m) {
+        std::vector<double> xs {uniform(rng), uniform(rng)};
+        if (a(input_t(xs)).first == b(input_t(xs)).first)
+            ++agree;
+    }
+    CHECK(agree > 0.99 * M);
+}
+
+template <class Kernel>
+void nu_path_test (svm::parameters<Kernel> params) {
+    using model_t = svm::model<Kernel>;
+    auto nu = [&params](double nu) {
+        svm::parameters<Kernel> p(params);
+        p.nu() = nu;
+        p.svm_params_ptr()->eps = 1e-5;
+        return p;
+    };
+
+    model_t warm(tile_problem<Kernel>(1000), nu(0.1));
+    for (double n : {0.2, 0.3, 0.5}) {
+        warm = model_t(std::move(warm), nu(n));
+        model_t cold(tile_problem<Kernel>(1000), nu(n));
+        check_same_predictions(cold, warm);
+    }
+}
+
+TEST_CASE("warm-start-nu-path-smo") {
+    nu_path_test(svm::parameters<svm::kernel::rbf>());
+}
+
+TEST_CASE("warm-start-nu-path-dcd") {
+    svm::parameters<svm::kernel::linear> params;
+    params.dual_coordinate_descent() = true;
+    nu_path_test(params);
+}
+
+TEST_CASE("warm-start-appended-samples") {
+    using kernel_t = svm::kernel::rbf;
+    using model_t = svm::model<kernel_t>;
+    svm::parameters<kernel_t> params(0.2, svm::machine_type::NU_SVC);
+    params.svm_params_ptr()->eps = 1e-5;
+
+    model_t prev(tile_problem<kernel_t>(1000), params);
+    model_t warm(extended_tile_problem<kernel_t>(1000, 200), params, prev);
+    model_t cold(extended_tile_problem<kernel_t>(1000, 200), params);
+    check_same_predictions(cold, warm);
+
+    // classifiers between tiles which have not grown are taken over
+    for (int a = 2; a < 9; ++a)
+        for (int b = a + 1; b < 9; ++b)
+            CHECK(warm.classifier(a, b).rho() == prev.classifier(a, b).rho());
+}
+
+TEST_CASE("warm-start-changed-samples") {
+    using kernel_t = svm::kernel::rbf;
+    using model_t = svm::model<kernel_t>;
+    svm::parameters<kernel_t> params(0.2, svm::machine_type::NU_SVC);
+    params.svm_params_ptr()->eps = 1e-5;
+
+    // the previous training set is as large as the present one, but its
+    // last samples differ; the classifiers must not be taken over
+    model_t prev(extended_tile_problem<kernel_t>(800, 200), params);
+    model_t warm(tile_problem<kernel_t>(1000), params, prev);
+    model_t cold(tile_problem<kernel_t>(1000), params);
+    check_same_predictions(cold, warm);
+    for (int a = 2; a < 9; ++a)
+        for (int b = a + 1; b < 9; ++b)
+            CHECK(warm.classifier(a, b).rho() != prev.classifier(a, b).rho());
+}
+
+TEST_CASE("warm-start-cross-validation") {
+    using kernel_t = svm::kernel::rbf;
+    using model_t = svm::model<kernel_t>;
+    svm::parameters<kernel_t> params(0.2, svm::machine_type::NU_SVC);
+
+    // the folds are smaller than the training set of the warm-start model,
+    // but must be trained from scratch nonetheless
+    model_t prev(tile_problem<kernel_t>(1000), params);
+    auto prob = tile_problem<kernel_t>(1000);
+    struct svm_problem svm_prob = prob.generate();
+    struct svm_parameter param = *params.svm_params_ptr();
+    std::vector<double> target_cold(prob.size()), target_warm(prob.size());
+    srand(1);
+    svm_cross_validation(&svm_prob, &param, 5, target_cold.data());
+    param.warm_start = prev.svm_model_ptr();
+    srand(1);
+    svm_cross_validation(&svm_prob, &param, 5, target_warm.data());
+    CHECK(target_warm == target_cold);
+}